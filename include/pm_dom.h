@@ -30,6 +30,27 @@
 #define SINGLE_PRECISION_FLOATING_POINT_DATA_LEN    4
 #define FIXED_DECIMAL_DATA_LEN                      2
 
+// SFP A2 alarm and warning thresholds (bytes 0 to 55), read once per module
+#define SFP_DOM_THRESHOLDS_OFFSET   0
+#define SFP_DOM_THRESHOLDS_LEN      56
+
+// SFP A2 live values, status and flags (bytes 96 to 119)
+#define SFP_DOM_LIVE_OFFSET         96
+#define SFP_DOM_LIVE_LEN            24
+
+// QSFP lower page interrupt flags and monitors (bytes 3 to 49)
+#define QSFP_DOM_LIVE_OFFSET        3
+#define QSFP_DOM_LIVE_LEN           47
+
+// QSFP status byte 2, flat memory (no upper pages) indication
+#define QSFP_STATUS_OFFSET          2
+#define QSFP_STATUS_FLAT_MEM        0x04
+
+// QSFP upper page 3 thresholds (bytes 128 to 199), read once per module
+#define QSFP_PAGE_SELECT_OFFSET     127
+#define QSFP_THRESHOLDS_PAGE        3
+#define QSFP_DOM_THRESHOLDS_OFFSET  128
+
 
 //
 //
@@ -586,138 +607,104 @@ typedef struct {
         unsigned char page_select_btye;
 } pm_qsfp_dom_t;
 
+// QSFP Upper Page 3 module and channel thresholds (byte 128 to 199)
+typedef struct {
+        // bytes 128 to 135
+        char temp_high_alarm_msb;
+        unsigned char temp_high_alarm_lsb;
+        char temp_low_alarm_msb;
+        unsigned char temp_low_alarm_lsb;
+        char temp_high_warning_msb;
+        unsigned char temp_high_warning_lsb;
+        char temp_low_warning_msb;
+        unsigned char temp_low_warning_lsb;
+
+        unsigned char reserved_136[8];
 
-struct ovs_module_dom_info {
-    char *temperature;
-    char *vcc;
-
-    char *temperature_high_alarm;
-    char *temperature_low_alarm;
-    char *temperature_high_warning;
-    char *temperature_low_warning;
-    char *vcc_high_alarm;
-    char *vcc_low_alarm;
-    char *vcc_high_warning;
-    char *vcc_low_warning;
-
-    char *temperature_high_alarm_threshold;
-    char *temperature_low_alarm_threshold;
-    char *temperature_high_warning_threshold;
-    char *temperature_low_warning_threshold;
-    char *vcc_high_alarm_threshold;
-    char *vcc_low_alarm_threshold;
-    char *vcc_high_warning_threshold;
-    char *vcc_low_warning_threshold;
-
-    // SFP Specific Variables
-    char *tx_bias;
-    char *rx_power;
-    char *tx_power;
-
-    char *tx_bias_high_alarm;
-    char *tx_bias_low_alarm;
-    char *tx_bias_high_warning;
-    char *tx_bias_low_warning;
-    char *tx_power_high_alarm;
-    char *tx_power_low_alarm;
-    char *tx_power_high_warning;
-    char *tx_power_low_warning;
-    char *rx_power_high_alarm;
-    char *rx_power_low_alarm;
-    char *rx_power_high_warning;
-    char *rx_power_low_warning;
-
-    char *tx_bias_high_alarm_threshold;
-    char *tx_bias_low_alarm_threshold;
-    char *tx_bias_high_warning_threshold;
-    char *tx_bias_low_warning_threshold;
-    char *tx_power_high_alarm_threshold;
-    char *tx_power_low_alarm_threshold;
-    char *tx_power_high_warning_threshold;
-    char *tx_power_low_warning_threshold;
-    char *rx_power_high_alarm_threshold;
-    char *rx_power_low_alarm_threshold;
-    char *rx_power_high_warning_threshold;
-    char *rx_power_low_warning_threshold;
-
-    // QSFP Secific Variables
-    char *tx1_bias;
-    char *tx2_bias;
-    char *tx3_bias;
-    char *tx4_bias;
-
-    char *rx1_power;
-    char *rx2_power;
-    char *rx3_power;
-    char *rx4_power;
-
-    char *tx1_bias_high_alarm;
-    char *tx1_bias_low_alarm;
-    char *tx1_bias_high_warning;
-    char *tx1_bias_low_warning;
-    char *tx2_bias_high_alarm;
-    char *tx2_bias_low_alarm;
-    char *tx2_bias_high_warning;
-    char *tx2_bias_low_warning;
-    char *tx3_bias_high_alarm;
-    char *tx3_bias_low_alarm;
-    char *tx3_bias_high_warning;
-    char *tx3_bias_low_warning;
-    char *tx4_bias_high_alarm;
-    char *tx4_bias_low_alarm;
-    char *tx4_bias_high_warning;
-    char *tx4_bias_low_warning;
-
-    char *rx1_power_high_alarm;
-    char *rx1_power_low_alarm;
-    char *rx1_power_high_warning;
-    char *rx1_power_low_warning;
-    char *rx2_power_high_alarm;
-    char *rx2_power_low_alarm;
-    char *rx2_power_high_warning;
-    char *rx2_power_low_warning;
-    char *rx3_power_high_alarm;
-    char *rx3_power_low_alarm;
-    char *rx3_power_high_warning;
-    char *rx3_power_low_warning;
-    char *rx4_power_high_alarm;
-    char *rx4_power_low_alarm;
-    char *rx4_power_high_warning;
-    char *rx4_power_low_warning;
-
-    char *tx1_bias_high_alarm_threshold;
-    char *tx1_bias_low_alarm_threshold;
-    char *tx1_bias_high_warning_threshold;
-    char *tx1_bias_low_warning_threshold;
-    char *tx2_bias_high_alarm_threshold;
-    char *tx2_bias_low_alarm_threshold;
-    char *tx2_bias_high_warning_threshold;
-    char *tx2_bias_low_warning_threshold;
-    char *tx3_bias_high_alarm_threshold;
-    char *tx3_bias_low_alarm_threshold;
-    char *tx3_bias_high_warning_threshold;
-    char *tx3_bias_low_warning_threshold;
-    char *tx4_bias_high_alarm_threshold;
-    char *tx4_bias_low_alarm_threshold;
-    char *tx4_bias_high_warning_threshold;
-    char *tx4_bias_low_warning_threshold;
-
-    char *rx1_power_high_alarm_threshold;
-    char *rx1_power_low_alarm_threshold;
-    char *rx1_power_high_warning_threshold;
-    char *rx1_power_low_warning_threshold;
-    char *rx2_power_high_alarm_threshold;
-    char *rx2_power_low_alarm_threshold;
-    char *rx2_power_high_warning_threshold;
-    char *rx2_power_low_warning_threshold;
-    char *rx3_power_high_alarm_threshold;
-    char *rx3_power_low_alarm_threshold;
-    char *rx3_power_high_warning_threshold;
-    char *rx3_power_low_warning_threshold;
-    char *rx4_power_high_alarm_threshold;
-    char *rx4_power_low_alarm_threshold;
-    char *rx4_power_high_warning_threshold;
-    char *rx4_power_low_warning_threshold;
+        // bytes 144 to 151
+        unsigned char voltage_high_alarm_msb;
+        unsigned char voltage_high_alarm_lsb;
+        unsigned char voltage_low_alarm_msb;
+        unsigned char voltage_low_alarm_lsb;
+        unsigned char voltage_high_warning_msb;
+        unsigned char voltage_high_warning_lsb;
+        unsigned char voltage_low_warning_msb;
+        unsigned char voltage_low_warning_lsb;
+
+        unsigned char reserved_152[24];
+
+        // bytes 176 to 183
+        unsigned char rx_power_high_alarm_msb;
+        unsigned char rx_power_high_alarm_lsb;
+        unsigned char rx_power_low_alarm_msb;
+        unsigned char rx_power_low_alarm_lsb;
+        unsigned char rx_power_high_warning_msb;
+        unsigned char rx_power_high_warning_lsb;
+        unsigned char rx_power_low_warning_msb;
+        unsigned char rx_power_low_warning_lsb;
+
+        // bytes 184 to 191
+        unsigned char bias_high_alarm_msb;
+        unsigned char bias_high_alarm_lsb;
+        unsigned char bias_low_alarm_msb;
+        unsigned char bias_low_alarm_lsb;
+        unsigned char bias_high_warning_msb;
+        unsigned char bias_high_warning_lsb;
+        unsigned char bias_low_warning_msb;
+        unsigned char bias_low_warning_lsb;
+
+        // bytes 192 to 199
+        unsigned char tx_power_high_alarm_msb;
+        unsigned char tx_power_high_alarm_lsb;
+        unsigned char tx_power_low_alarm_msb;
+        unsigned char tx_power_low_alarm_lsb;
+        unsigned char tx_power_high_warning_msb;
+        unsigned char tx_power_high_warning_lsb;
+        unsigned char tx_power_low_warning_msb;
+        unsigned char tx_power_low_warning_lsb;
+} pm_qsfp_dom_thresholds_t;
+
+// DOM thresholds, as read from the module
+typedef union {
+        unsigned char sfp[SFP_DOM_THRESHOLDS_LEN];  // A2 bytes 0 to 55
+        pm_qsfp_dom_thresholds_t qsfp;              // page 3 bytes 128 to 199
+} pm_dom_thresholds_t;
+
+
+// DOM measurements
+enum pm_dom_measure {
+    PM_DOM_TEMPERATURE,                 /* signed, 1/256 C */
+    PM_DOM_VCC,                         /* 100 uV */
+    PM_DOM_TX_BIAS,                     /* 2 uA, per lane */
+    PM_DOM_RX_POWER,                    /* 0.1 uW, per lane */
+    PM_DOM_TX_POWER,                    /* 0.1 uW, per lane */
+    PM_DOM_MEASURE_MAX
+};
+
+// alarm/warning levels, for flags and thresholds
+enum pm_dom_level {
+    PM_DOM_HIGH_ALARM,
+    PM_DOM_LOW_ALARM,
+    PM_DOM_HIGH_WARNING,
+    PM_DOM_LOW_WARNING,
+    PM_DOM_LEVEL_MAX
 };
 
+#define PM_DOM_LANES                4   /* SFP modules use lane 0 only */
+
+#define PM_DOM_MEASURE_BIT(measure) (1u << (measure))
+#define PM_DOM_FLAG_BIT(lane, level) (1u << ((lane) * PM_DOM_LEVEL_MAX + (level)))
+
+// DOM data of a module, as raw module values. Strings are only rendered
+// when the data is written to OVSDB or dumped (pm_dom_render).
+typedef struct {
+    uint8_t     lanes;                  /* 1 for SFP, PM_DOM_LANES for QSFP */
+    uint8_t     values_valid;           /* PM_DOM_MEASURE_BIT's */
+    uint8_t     flags_valid;            /* PM_DOM_MEASURE_BIT's */
+    uint8_t     thresholds_valid;       /* PM_DOM_MEASURE_BIT's */
+    uint16_t    value[PM_DOM_MEASURE_MAX][PM_DOM_LANES];
+    uint16_t    flags[PM_DOM_MEASURE_MAX];  /* PM_DOM_FLAG_BIT's */
+    uint16_t    threshold[PM_DOM_MEASURE_MAX][PM_DOM_LEVEL_MAX];
+} pm_dom_store_t;
+
 #endif
@@ -19,10 +19,11 @@
 
 import time
 from pytest import fixture
-from os.path import dirname, isdir
+from os.path import dirname, isdir, join
 from os import chdir
 from json import loads
 from shutil import copy
+from struct import pack_into
 
 TOPOLOGY = """
 # +-------+
@@ -37,6 +38,10 @@ TOPOLOGY = """
 test_file_dir = "/files"
 sfp_interface = "21"
 qsfp_interface = "49"
+# simulation module event FIFO in the ops-pmd run directory
+event_fifo = "/var/run/openvswitch/ops-pmd.events"
+# presence sweep interval of ports with module events (seconds)
+sweep_interval = 5
 # sample files and expected results for SFPs
 sfp_files = {
     "SFP_DAC_MOLEX.bin": {
@@ -131,6 +136,34 @@ def remove_pluggable(interface, sw1):
     time.sleep(0.5)
 
 
+# insert or remove a module without an event, so that only the presence
+# sweep or a write to the event FIFO finds it
+def insert_pluggable_noevent(interface, module, sw1):
+    copy(module, sw1.shared_dir)
+    sw1("ovs-appctl -t ops-pmd ops-pmd/sim {} insert /tmp/{} noevent"
+        "".format(interface, module), shell='bash')
+
+
+def remove_pluggable_noevent(interface, sw1):
+    sw1("ovs-appctl -t ops-pmd ops-pmd/sim {} remove noevent"
+        "".format(interface), shell='bash')
+
+
+def send_event(interface, sw1):
+    sw1("echo {} > {}".format(interface, event_fifo), shell='bash')
+
+
+# poll pm_info until the connector matches, or the timeout (in seconds)
+# runs out
+def wait_for_connector(interface, connector, timeout, sw1):
+    deadline = time.time() + timeout
+    while True:
+        pm_info = get_interface(interface, sw1)
+        if pm_info["connector"] == connector or time.time() > deadline:
+            return pm_info
+        time.sleep(0.1)
+
+
 def get_interface(interface, sw1):
     pm_info = dict()
     out = sw1("ovs-vsctl --columns=pm_info --format=json list interface {}"
@@ -174,6 +207,231 @@ def _test_insert_remove_module(interface, dataset, sw1):
         assert pm_info["connector_status"] == "unrecognized"
 
 
+def _test_module_events(interface, module, connector, sw1):
+    insert_pluggable_noevent(interface, module, sw1)
+    send_event(interface, sw1)
+    pm_info = wait_for_connector(interface, connector, 1, sw1)
+    assert pm_info["connector"] == connector
+    remove_pluggable_noevent(interface, sw1)
+    send_event(interface, sw1)
+    pm_info = wait_for_connector(interface, "absent", 1, sw1)
+    assert pm_info["connector"] == "absent"
+    assert pm_info["connector_status"] == "unrecognized"
+
+
+def _test_presence_sweep(interface, module, connector, sw1):
+    insert_pluggable_noevent(interface, module, sw1)
+    pm_info = wait_for_connector(interface, connector, sweep_interval + 1,
+                                 sw1)
+    assert pm_info["connector"] == connector
+    remove_pluggable_noevent(interface, sw1)
+    pm_info = wait_for_connector(interface, "absent", sweep_interval + 1,
+                                 sw1)
+    assert pm_info["connector"] == "absent"
+    assert pm_info["connector_status"] == "unrecognized"
+
+
+# parse an appctl table: header columns, and the rows by their first column
+def get_table(out):
+    lines = [line.split() for line in out.splitlines() if line.strip()]
+    header = lines[0]
+    rows = dict()
+    for row in lines[1:]:
+        rows[row[0]] = row[1:]
+    return header, rows
+
+
+def get_cadence(sw1):
+    out = sw1("ovs-appctl -t ops-pmd ops-pmd/cadence", shell='bash')
+    return get_table(out)
+
+
+def set_cadence(args, sw1):
+    return sw1("ovs-appctl -t ops-pmd ops-pmd/cadence {} 2>&1"
+               "".format(args), shell='bash')
+
+
+def _test_cadence(sw1):
+    header, rows = get_cadence(sw1)
+    assert header[0] == "class"
+    assert "presence" in header
+    assert "dom" in header
+    assert sorted(rows) == ["QSFP28", "QSFP_PLUS", "SFP_PLUS"]
+    dom = header.index("dom") - 1
+    sfp_default = rows["SFP_PLUS"][dom]
+    presence = header.index("presence") - 1
+    sfp_presence_default = rows["SFP_PLUS"][presence]
+    qsfp_default = rows["QSFP_PLUS"][dom]
+    out = set_cadence("SFP_PLUS dom 10000", sw1)
+    assert "SFP_PLUS dom cadence set to 10000 msecs" in out
+    header, rows = get_cadence(sw1)
+    assert rows["SFP_PLUS"][dom] == "10000"
+    assert rows["QSFP_PLUS"][dom] == qsfp_default
+    out = set_cadence("BOGUS dom 10000", sw1)
+    assert "Unknown connector class: BOGUS" in out
+    out = set_cadence("SFP_PLUS bogus 10000", sw1)
+    assert "Unknown task: bogus" in out
+    out = set_cadence("SFP_PLUS dom abc", sw1)
+    assert "Invalid cadence: abc" in out
+    out = set_cadence("SFP_PLUS presence ''", sw1)
+    assert "Invalid cadence: " in out
+    header, rows = get_cadence(sw1)
+    assert rows["SFP_PLUS"][presence] == sfp_presence_default
+    out = set_cadence("SFP_PLUS dom {}".format(sfp_default), sw1)
+    header, rows = get_cadence(sw1)
+    assert rows["SFP_PLUS"][dom] == sfp_default
+
+
+def scan_threads(args, sw1):
+    return sw1("ovs-appctl -t ops-pmd ops-pmd/scan-threads {} 2>&1"
+               "".format(args), shell='bash')
+
+
+def _test_scan_threads(sw1):
+    out = scan_threads("", sw1)
+    assert "scan threads: off" in out
+    assert "workers running: 0" in out
+    out = scan_threads("on", sw1)
+    assert "scan threads on" in out
+    out = scan_threads("", sw1)
+    assert "scan threads: on" in out
+    out = scan_threads("bogus", sw1)
+    assert "Invalid scan threads state: bogus" in out
+    out = scan_threads("off", sw1)
+    assert "scan threads off" in out
+    out = scan_threads("", sw1)
+    assert "scan threads: off" in out
+    assert "workers running: 0" in out
+
+
+def get_deadbands(sw1):
+    out = sw1("ovs-appctl -t ops-pmd ops-pmd/deadband", shell='bash')
+    return get_table(out)
+
+
+def set_deadband(args, sw1):
+    return sw1("ovs-appctl -t ops-pmd ops-pmd/deadband {} 2>&1"
+               "".format(args), shell='bash')
+
+
+def _test_deadband(sw1):
+    header, rows = get_deadbands(sw1)
+    assert header == ["measure", "absolute", "relative"]
+    assert sorted(rows) == ["rx_power", "temperature", "tx_bias",
+                            "tx_power", "vcc"]
+    vcc_default = rows["vcc"]
+    temperature_default = rows["temperature"]
+    out = set_deadband("vcc 0.05 2", sw1)
+    assert "vcc deadband set to 0.05, 2%" in out
+    header, rows = get_deadbands(sw1)
+    assert rows["vcc"] == ["0.05", "2%"]
+    assert rows["temperature"] == temperature_default
+    out = set_deadband("bogus 0.05 2", sw1)
+    assert "Unknown measure: bogus" in out
+    out = set_deadband("vcc abc 2", sw1)
+    assert "Invalid absolute deadband: abc" in out
+    out = set_deadband("vcc 0.05 abc", sw1)
+    assert "Invalid relative deadband: abc" in out
+    out = set_deadband("vcc nan 2", sw1)
+    assert "Invalid absolute deadband: nan" in out
+    out = set_deadband("vcc 0.05 inf", sw1)
+    assert "Invalid relative deadband: inf" in out
+    out = set_deadband("vcc '' 2", sw1)
+    assert "Invalid absolute deadband: " in out
+    header, rows = get_deadbands(sw1)
+    assert rows["vcc"] == ["0.05", "2%"]
+    out = set_deadband("vcc {} {}".format(vcc_default[0],
+                                          vcc_default[1].rstrip("%")), sw1)
+    header, rows = get_deadbands(sw1)
+    assert rows["vcc"] == vcc_default
+
+
+# build an SFP A2 page: temperature in C, vcc in V, the temperature high
+# alarm threshold in C, and the temperature high alarm flag
+def sfp_dom_page(temperature, vcc, high_alarm_threshold=80.0,
+                 high_alarm=False):
+    page = bytearray(128)
+    pack_into(">h", page, 0, int(round(high_alarm_threshold * 256)))
+    pack_into(">h", page, 96, int(round(temperature * 256)))
+    pack_into(">H", page, 98, int(round(vcc * 10000)))
+    if high_alarm:
+        page[112] |= 0x80
+    return page
+
+
+def feed_dom(interface, name, page, sw1):
+    with open(join(sw1.shared_dir, name), "wb") as f:
+        f.write(page)
+    return sw1("ovs-appctl -t ops-pmd ops-pmd/sim {} dom /tmp/{} 2>&1"
+               "".format(interface, name), shell='bash')
+
+
+def get_dom(interface, sw1):
+    out = sw1("ovs-appctl -t ops-pmd ops-pmd/dump interface {}"
+              "".format(interface), shell='bash')
+    dom = dict()
+    for line in out.splitlines():
+        key_value = line.split(" = ")
+        if len(key_value) == 2:
+            dom[key_value[0].strip()] = key_value[1].strip()
+    return dom
+
+
+def _test_dom_publish(interface, module, sw1):
+    header, rows = get_deadbands(sw1)
+    temperature_default = rows["temperature"]
+    vcc_default = rows["vcc"]
+    set_deadband("temperature 0.5 0", sw1)
+    set_deadband("vcc 0.01 0", sw1)
+    insert_pluggable(interface, module, sw1)
+    out = feed_dom(interface, "dom_base.bin", sfp_dom_page(30.0, 3.3), sw1)
+    assert "DOM data published" in out
+    dom = get_dom(interface, sw1)
+    assert dom["temperature"] == "30.00"
+    assert dom["vcc"] == "3.30"
+    assert dom["temperature_high_alarm"] == "Off"
+    assert dom["temperature_high_alarm_threshold"] == "80.00"
+    # inside the temperature (0.5 C) and vcc (0.01 V) deadbands
+    out = feed_dom(interface, "dom_noise.bin", sfp_dom_page(30.25, 3.305),
+                   sw1)
+    assert "DOM data unchanged" in out
+    dom = get_dom(interface, sw1)
+    assert dom["temperature"] == "30.00"
+    assert dom["vcc"] == "3.30"
+    # flag changes are published, even inside the deadbands
+    out = feed_dom(interface, "dom_alarm.bin",
+                   sfp_dom_page(30.25, 3.3, high_alarm=True), sw1)
+    assert "DOM data published" in out
+    dom = get_dom(interface, sw1)
+    assert dom["temperature"] == "30.25"
+    assert dom["temperature_high_alarm"] == "On"
+    # threshold changes are published, even inside the deadbands
+    out = feed_dom(interface, "dom_threshold.bin",
+                   sfp_dom_page(30.25, 3.3, 70.0, high_alarm=True), sw1)
+    assert "DOM data published" in out
+    dom = get_dom(interface, sw1)
+    assert dom["temperature_high_alarm_threshold"] == "70.00"
+    # outside the temperature deadband
+    out = feed_dom(interface, "dom_warm.bin",
+                   sfp_dom_page(31.0, 3.3, 70.0, high_alarm=True), sw1)
+    assert "DOM data published" in out
+    dom = get_dom(interface, sw1)
+    assert dom["temperature"] == "31.00"
+    # a wider deadband suppresses the same step
+    set_deadband("temperature 2 0", sw1)
+    out = feed_dom(interface, "dom_base.bin",
+                   sfp_dom_page(30.0, 3.3, 70.0, high_alarm=True), sw1)
+    assert "DOM data unchanged" in out
+    set_deadband("temperature {} {}".format(
+        temperature_default[0], temperature_default[1].rstrip("%")), sw1)
+    set_deadband("vcc {} {}".format(vcc_default[0],
+                                    vcc_default[1].rstrip("%")), sw1)
+    header, rows = get_deadbands(sw1)
+    assert rows["temperature"] == temperature_default
+    assert rows["vcc"] == vcc_default
+    remove_pluggable(interface, sw1)
+
+
 def test_pmd(topology, step):
     sw1 = topology.get("sw1")
     step("1-Testing initial conditions\n")
@@ -196,3 +454,15 @@ def test_pmd(topology, step):
     _test_insert_remove_module(sfp_interface, sfp_files, sw1)
     step("3-Testing module insertion/removal of QSFP+s\n")
     _test_insert_remove_module(qsfp_interface, qsfp_files, sw1)
+    step("4-Testing module insertion/removal through the event FIFO\n")
+    _test_module_events(sfp_interface, "SFP_SR_AVAGO.bin", "SFP_SR", sw1)
+    step("5-Testing module insertion/removal found by the presence sweep\n")
+    _test_presence_sweep(sfp_interface, "SFP_SR_AVAGO.bin", "SFP_SR", sw1)
+    step("6-Testing the presence and poll cadences\n")
+    _test_cadence(sw1)
+    step("7-Testing the DOM publishing deadbands\n")
+    _test_deadband(sw1)
+    step("8-Testing DOM publishing inside and outside the deadbands\n")
+    _test_dom_publish(sfp_interface, "SFP_SR_AVAGO.bin", sw1)
+    step("9-Testing the scan threads setting\n")
+    _test_scan_threads(sw1)
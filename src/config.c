@@ -21,8 +21,11 @@
  * Source file for pluggable module config-yaml interface functions.
  ***************************************************************************/
 
+#include <stdlib.h>
 #include <string.h>
 
+#include <shash.h>
+#include <util.h>
 #include <vswitch-idl.h>
 #include <openswitch-idl.h>
 
@@ -35,7 +38,9 @@
 VLOG_DEFINE_THIS_MODULE(config);
 
 YamlConfigHandle global_yaml_handle;
-extern struct shash ovs_intfs;
+
+// subsystem name -> port index (struct shash of port name -> YamlPort)
+static struct shash pm_yaml_port_indexes = SHASH_INITIALIZER(&pm_yaml_port_indexes);
 
 
 void
@@ -45,32 +50,90 @@ pm_config_init(void)
 }
 
 /*
- * pm_get_yaml_port: find a matching port by instance name
+ * pm_yaml_port_index_invalidate: drop the port index of a subsystem, its
+ *                                ports are being re-read or removed
  *
- * input: subsystem name, instance string
+ * input: subsystem name
  *
- * output: pointer to matching YamlPort object
+ * output: none
  */
-const YamlPort *
-pm_get_yaml_port(const char *subsystem, const char *instance)
+void
+pm_yaml_port_index_invalidate(const char *subsystem)
 {
+    struct shash *index;
+
+    index = shash_find_and_delete(&pm_yaml_port_indexes, subsystem);
+    if (NULL != index) {
+        shash_destroy(index);
+        free(index);
+    }
+}
+
+/*
+ * pm_yaml_port_index: get the port index of a subsystem, building it from
+ *                     the YAML ports on first use
+ *
+ * input: subsystem name
+ *
+ * output: port name -> YamlPort map
+ */
+static struct shash *
+pm_yaml_port_index(const char *subsystem)
+{
+    struct shash    *index;
     size_t          count;
     size_t          idx;
     const YamlPort *yaml_port;
 
+    index = shash_find_data(&pm_yaml_port_indexes, subsystem);
+    if (NULL != index) {
+        return index;
+    }
+
+    index = xmalloc(sizeof(*index));
+    shash_init(index);
+
     count = yaml_get_port_count(global_yaml_handle, subsystem);
 
-    // lookup port in YAML data
     for (idx = 0; idx < count; idx++) {
         yaml_port = yaml_get_port(global_yaml_handle, subsystem, idx);
 
-        // find matching instance
-        if (strcmp(yaml_port->name, instance) == 0) {
-            return(yaml_port);
-        }
+        // the first port with a name wins, as with the linear lookup
+        shash_add_once(index, yaml_port->name, yaml_port);
     }
 
-    return(NULL);
+    shash_add(&pm_yaml_port_indexes, subsystem, index);
+
+    VLOG_DBG("indexed %zu YAML ports for subsystem %s", count, subsystem);
+
+    return index;
+}
+
+/*
+ * pm_get_yaml_ports: get all YAML ports of a subsystem
+ *
+ * input: subsystem name
+ *
+ * output: port name -> YamlPort map, valid until the subsystem's ports are
+ *         re-read or removed
+ */
+const struct shash *
+pm_get_yaml_ports(const char *subsystem)
+{
+    return pm_yaml_port_index(subsystem);
+}
+
+/*
+ * pm_get_yaml_port: find a matching port by instance name
+ *
+ * input: subsystem name, instance string
+ *
+ * output: pointer to matching YamlPort object
+ */
+const YamlPort *
+pm_get_yaml_port(const char *subsystem, const char *instance)
+{
+    return shash_find_data(pm_yaml_port_index(subsystem), instance);
 }
 
 /*
@@ -89,14 +152,12 @@ pm_create_a2_devices(void)
     char                *new_name;
     int                 name_len;
     int                 rc;
-    struct shash_node   *node;
-
-    SHASH_FOR_EACH(node, &ovs_intfs) {
-        pm_port_t *port;
-
-        port = (pm_port_t *)node->data;
+    pm_port_t           *port;
+    size_t              id;
 
-        yaml_port = pm_get_yaml_port(port->subsystem, port->instance);
+    PM_PORT_FOR_EACH(port, id) {
+        // resolved when the port was created
+        yaml_port = port->cold->module_device;
 
         // if the port isn't pluggable, skip it
         if (false == yaml_port->pluggable) {
@@ -109,7 +170,7 @@ pm_create_a2_devices(void)
         }
 
         // find the matching a0 device for the port
-        a0_device = yaml_find_device(global_yaml_handle, port->subsystem, yaml_port->module_eeprom);
+        a0_device = yaml_find_device(global_yaml_handle, port->cold->subsystem, yaml_port->module_eeprom);
 
         if (NULL == a0_device) {
             VLOG_WARN("Unable to find eeprom device for SFP+ port: %s",
@@ -136,7 +197,7 @@ pm_create_a2_devices(void)
         a2_device.post = a0_device->post;
 
         // add the new device entry into the yaml data
-        rc = yaml_add_device(global_yaml_handle, port->subsystem, new_name, &a2_device);
+        rc = yaml_add_device(global_yaml_handle, port->cold->subsystem, new_name, &a2_device);
 
         if (0 != rc) {
             VLOG_ERR("Unable to add A2 device for SFP+ port: %s",
@@ -145,6 +206,9 @@ pm_create_a2_devices(void)
         }
 
         free(new_name);
+
+        // the port can use the new device, now
+        pm_build_access_plan(port);
     }
 }
 
@@ -175,7 +239,8 @@ pm_read_yaml_files(const struct ovsrec_subsystem *subsys)
         goto end;
     }
 
-    // read ports
+    // read ports, the old port index is stale
+    pm_yaml_port_index_invalidate(subsys->name);
     rc = yaml_parse_ports(global_yaml_handle, subsys->name);
 
     if (0 != rc) {
@@ -189,6 +254,9 @@ pm_read_yaml_files(const struct ovsrec_subsystem *subsys)
     // send i2c initialization commands
     yaml_init_devices(global_yaml_handle, subsys->name);
 
+    // module event sources are optional, polling is used without them
+    pm_event_read_config(subsys->name, subsys->hw_desc_dir);
+
 end:
     // could try to clean up yaml handle on error, but the application is
     // going to abort, so there's not much point to it.
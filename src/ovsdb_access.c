@@ -30,6 +30,8 @@
 #include "config-yaml.h"
 
 #include <dynamic-string.h>
+#include <list.h>
+#include <util.h>
 #include <vswitch-idl.h>
 #include <openswitch-idl.h>
 
@@ -46,7 +48,19 @@ static unsigned int idl_seqno;
 
 static bool cur_hw_set = false;
 
-struct shash ovs_intfs;
+// transaction in flight, there is at most one at a time
+static struct ovsdb_idl_txn *pm_txn = NULL;
+
+// cur_hw is set by the transaction in flight
+static bool cur_hw_pending = false;
+
+// ports written by the transaction in flight
+static struct ovs_list pm_txn_ports = OVS_LIST_INITIALIZER(&pm_txn_ports);
+
+// the managed subsystems changed, the Interface monitor condition must be
+// updated
+static bool pm_intf_condition_changed = false;
+
 struct shash ovs_subs;
 
 static bool
@@ -88,31 +102,39 @@ ovsdb_if_intf_create(const struct ovsrec_interface *intf, const char *sub_name)
         goto end;
     }
 
-    // create a new data structure to hold the port info data
-    port = (pm_port_t *)calloc(sizeof(pm_port_t), 1);
+    // add the port to the port table, with the instance and the row uuid
+    // as keys
+    port = pm_port_alloc(instance, &intf->header_.uuid);
 
     // fill in the structure
-    port->instance = strdup(instance);
-    memcpy(&port->uuid, &intf->header_.uuid, sizeof(intf->header_.uuid));
-    port->subsystem = strdup(sub_name);
+    port->cold->subsystem = strdup(sub_name);
 
     port->hw_enable = ovsdb_if_intf_get_hw_enable(intf);
 
-    port->module_device = yaml_port;
+    port->cold->module_device = yaml_port;
+
+    // resolve the devices and signals used to access the module
+    pm_build_access_plan(port);
 
     // mark it as absent, first, so it will be processed at least once
     port->present = false;
 
     port->retry = false;
 
-    // add the port to the ovs_intfs shash, with the instance as the key
-    shash_add(&ovs_intfs, port->instance, (void *)port);
+    port->reset_state = PM_RESET_READY;
+    port->reset_retries = PM_RESET_RETRIES;
+
+    // the port needs to be added to a scan group
+    pm_scan_invalidate();
 
     VLOG_DBG("pm_port instance (%s) added", instance);
 
     // apply initial hw_enable state.
     pm_configure_port(port);
 
+    // schedule the port's tasks, which are due right away
+    pm_sched_add_port(port);
+
     // clear reset (if hardware supports reset)
     pm_clear_reset(port);
 
@@ -140,13 +162,11 @@ ovsdb_if_intf_modify(const struct ovsrec_interface *intf, pm_port_t *port)
 static void
 ovsdb_if_intf_configure(const struct ovsrec_interface *intf)
 {
-    struct shash_node *node;
     pm_port_t *port;
 
-    node = shash_find(&ovs_intfs, intf->name);
+    port = pm_port_find_by_uuid(&intf->header_.uuid);
 
-    if (node != NULL) {
-        port = (pm_port_t *)node->data;
+    if (port != NULL) {
         pm_configure_port(port);
     }
 }
@@ -172,6 +192,9 @@ ovsdb_if_subsys_process(const struct ovsrec_subsystem *ovs_sub)
                      ovs_sub->name, rc);
             return;
         }
+
+        // monitor the interfaces of the subsystem's pluggable ports
+        pm_intf_condition_changed = true;
     }
 
     // make sure that all of the interfaces that are present in the subsystem
@@ -181,501 +204,367 @@ ovsdb_if_subsys_process(const struct ovsrec_subsystem *ovs_sub)
         const struct ovsrec_interface *intf;
 
         intf = ovs_sub->interfaces[i];
-        node = shash_find(&ovs_intfs, intf->name);
-        if (node == NULL) {
+        if (NULL == pm_port_find_by_uuid(&intf->header_.uuid)) {
             ovsdb_if_intf_create(intf, ovs_sub->name);
         }
     }
 }
 
-void
-pm_ovsdb_update(void)
+//
+// pm_port_intf: get the Interface row of a port
+//
+// input: port structure
+//
+// output: row, or NULL if the row has been deleted
+//
+// The row is looked up once per IDL seqno; row pointers stay valid until
+// the IDL changes.
+//
+static const struct ovsrec_interface *
+pm_port_intf(pm_port_t *port)
 {
-    struct ovsdb_idl_txn *txn;
-    const struct ovsrec_interface *intf;
-    const struct ovsrec_daemon *db_daemon;
-    pm_port_t   *port = NULL;
-    struct shash_node *node;
+    pm_port_cold_t *cold = port->cold;
+    unsigned int seqno = ovsdb_idl_get_seqno(idl);
 
-    txn = ovsdb_idl_txn_create(idl);
+    if (NULL == cold->intf || cold->intf_seqno != seqno) {
+        cold->intf = ovsrec_interface_get_for_uuid(idl, &cold->uuid);
+        cold->intf_seqno = seqno;
+    }
 
-    // Loop through all interfaces and update pluggable module
-    // info in the database if necessary.
-    SHASH_FOR_EACH(node, &ovs_intfs) {
-        struct ovs_module_info *module;
-        struct ovs_module_dom_info *module_dom;
-        struct smap pm_info;
+    return cold->intf;
+}
 
-        port = (pm_port_t *)node->data;
+// dirty bits of all ovs_module_info fields fit in pm_info_dirty
+BUILD_ASSERT_DECL(PM_INFO_N_FIELDS <= 32);
+
+// pm_info keys of the ovs_module_info fields, by field index. Fields
+// without a key aren't written.
+static const char *pm_info_keys[PM_INFO_N_FIELDS] = {
+    /*
+    [PM_INFO_FIELD_IDX(cable_length)] = "cable_length",
+    [PM_INFO_FIELD_IDX(cable_technology)] = "cable_technology",*/
+    [PM_INFO_FIELD_IDX(connector)] = "connector",
+    [PM_INFO_FIELD_IDX(connector_status)] = "connector_status",
+    [PM_INFO_FIELD_IDX(supported_speeds)] = "supported_speeds",
+    [PM_INFO_FIELD_IDX(max_speed)] = "max_speed",/*
+    [PM_INFO_FIELD_IDX(power_mode)] = "power_mode",
+    [PM_INFO_FIELD_IDX(vendor_name)] = "vendor_name",*/
+    /*[PM_INFO_FIELD_IDX(vendor_oui)] = "vendor_oui",*//*
+    [PM_INFO_FIELD_IDX(vendor_part_number)] = "vendor_part_number",
+    [PM_INFO_FIELD_IDX(vendor_revision)] = "vendor_revision",
+    [PM_INFO_FIELD_IDX(vendor_serial_number)] = "vendor_serial_number",*/
+};
+
+//
+// pm_info_field_written: check if an ovs_module_info field has a pm_info
+//                        key
+//
+// input: field index
+//
+// output: true if changes to the field are written to the database
+//
+bool
+pm_info_field_written(size_t idx)
+{
+    return idx < PM_INFO_N_FIELDS && NULL != pm_info_keys[idx];
+}
 
-        // if there's no port, it's probably not pluggable
-        if (NULL == port) {
-            continue;
-        }
+static const char *
+pm_info_field(const pm_port_t *port, size_t idx)
+{
+    return *(char * const *)((const char *)&port->cold->ovs_module_columns +
+                             idx * sizeof(char *));
+}
 
-        intf = ovsrec_interface_get_for_uuid(idl, &port->uuid);
-        if (NULL == intf) {
-            VLOG_ERR("No DB entry found for hw interface %s\n",
-                     port->instance);
-            continue;
-        }
-        if (false == port->module_info_changed) {
-            continue;
-        }
+//
+// pm_info_to_smap: build the whole pm_info map of a port
+//
+static void
+pm_info_to_smap(const pm_port_t *port, struct smap *pm_info)
+{
+    const char *value;
+    size_t idx;
 
-        module = &port->ovs_module_columns;
-        // Set pm_info map
-        smap_init(&pm_info);
-        /*
-        if (module->cable_length) {
-            ;//smap_add(&pm_info, "cable_length", module->cable_length);
-        }
-        if (module->cable_technology) {
-            smap_add(&pm_info, "cable_technology", module->cable_technology);
-        }*/
-        if (module->connector) {
-            smap_add(&pm_info, "connector", module->connector);
-        }
-        if (module->connector_status) {        	
-            smap_add(&pm_info, "connector_status", module->connector_status);
-        }
-        if (module->supported_speeds) {
-            smap_add(&pm_info, "supported_speeds", module->supported_speeds);
+    for (idx = 0; idx < PM_INFO_N_FIELDS; idx++) {
+        value = pm_info_field(port, idx);
+        if (NULL != pm_info_keys[idx] && NULL != value) {
+            smap_add(pm_info, pm_info_keys[idx], value);
         }
-        //if(cnt > 50)
-        if (module->max_speed) {
-            smap_add(&pm_info, "max_speed", module->max_speed);
-        }/*
-        if (module->power_mode) {
-            smap_add(&pm_info, "power_mode", module->power_mode);
-        }
-        if (module->vendor_name) {
-            smap_add(&pm_info, "vendor_name", module->vendor_name);
-        }*/
-        /*if (module->vendor_oui) {
-            smap_add(&pm_info, "vendor_oui", module->vendor_oui);
-        }*//*
-        if (module->vendor_part_number) {
-            smap_add(&pm_info, "vendor_part_number",
-                     module->vendor_part_number);
-        }
-        if (module->vendor_revision) {
-            smap_add(&pm_info, "vendor_revision", module->vendor_revision);
-        }
-        if (module->vendor_serial_number) {
-            smap_add(&pm_info, "vendor_serial_number",
-                     module->vendor_serial_number);
-        }*/
+    }
 
-				
-        // Update diagnostics key values
-        module_dom = &port->ovs_module_dom_columns;
+    // Update diagnostics key values
 /*
-        if (module_dom->temperature) {
-            smap_add(&pm_info, "temperature", module_dom->temperature);
-        }
-        if (module_dom->temperature_high_alarm) {
-            smap_add(&pm_info, "temperature_high_alarm", module_dom->temperature_high_alarm);
-        }
-        if (module_dom->temperature_low_alarm) {
-            smap_add(&pm_info, "temperature_low_alarm", module_dom->temperature_low_alarm);
-        }
-        if (module_dom->temperature_high_warning) {
-            smap_add(&pm_info, "temperature_high_warning", module_dom->temperature_high_warning);
-        }
-        if (module_dom->temperature_low_warning) {
-            smap_add(&pm_info, "temperature_low_warning", module_dom->temperature_low_warning);
-        }
-        if (module_dom->temperature_high_alarm_threshold) {
-            smap_add(&pm_info, "temperature_high_alarm_threshold", module_dom->temperature_high_alarm_threshold);
-        }
-        if (module_dom->temperature_low_alarm_threshold) {
-            smap_add(&pm_info, "temperature_low_alarm_threshold", module_dom->temperature_low_alarm_threshold);
-        }
-        if (module_dom->temperature_high_warning_threshold) {
-            smap_add(&pm_info, "temperature_high_warning_threshold", module_dom->temperature_high_warning_threshold);
-        }
-        if (module_dom->temperature_low_warning_threshold) {
-            smap_add(&pm_info, "temperature_low_warning_threshold", module_dom->temperature_low_warning_threshold);
-        }
-
-        if (module_dom->vcc) {
-            smap_add(&pm_info, "vcc", module_dom->vcc);
-        }
-        if (module_dom->vcc_high_alarm) {
-            smap_add(&pm_info, "vcc_high_alarm", module_dom->vcc_high_alarm);
-        }
-        if (module_dom->vcc_low_alarm) {
-            smap_add(&pm_info, "vcc_low_alarm", module_dom->vcc_low_alarm);
-        }
-        if (module_dom->vcc_high_warning) {
-            smap_add(&pm_info, "vcc_high_warning", module_dom->vcc_high_warning);
-        }
-        if (module_dom->vcc_low_warning) {
-            smap_add(&pm_info, "vcc_low_warning", module_dom->vcc_low_warning);
-        }
-        if (module_dom->vcc_high_alarm_threshold) {
-            smap_add(&pm_info, "vcc_high_alarm_threshold", module_dom->vcc_high_alarm_threshold);
-        }
-        if (module_dom->vcc_low_alarm_threshold) {
-            smap_add(&pm_info, "vcc_low_alarm_threshold", module_dom->vcc_low_alarm_threshold);
-        }
-        if (module_dom->vcc_high_warning_threshold) {
-            smap_add(&pm_info, "vcc_high_warning_threshold", module_dom->vcc_high_warning_threshold);
-        }
-        if (module_dom->vcc_low_warning_threshold) {
-            smap_add(&pm_info, "vcc_low_warning_threshold", module_dom->vcc_low_warning_threshold);
-        }
-
-        if (module_dom->tx_bias) {
-            smap_add(&pm_info, "tx_bias", module_dom->tx_bias);
-        }
-        if (module_dom->tx_bias_high_alarm) {
-            smap_add(&pm_info, "tx_bias_high_alarm", module_dom->tx_bias_high_alarm);
-        }
-        if (module_dom->tx_bias_low_alarm) {
-            smap_add(&pm_info, "tx_bias_low_alarm", module_dom->tx_bias_low_alarm);
-        }
-        if (module_dom->tx_bias_high_warning) {
-            smap_add(&pm_info, "tx_bias_high_warning", module_dom->tx_bias_high_warning);
-        }
-        if (module_dom->tx_bias_low_warning) {
-            smap_add(&pm_info, "tx_bias_low_warning", module_dom->tx_bias_low_warning);
-        }
-        if (module_dom->tx_bias_high_alarm_threshold) {
-            smap_add(&pm_info, "tx_bias_high_alarm_threshold", module_dom->tx_bias_high_alarm_threshold);
-        }
-        if (module_dom->tx_bias_low_alarm_threshold) {
-            smap_add(&pm_info, "tx_bias_low_alarm_threshold", module_dom->tx_bias_low_alarm_threshold);
-        }
-        if (module_dom->tx_bias_high_warning_threshold) {
-            smap_add(&pm_info, "tx_bias_high_warning_threshold", module_dom->tx_bias_high_warning_threshold);
-        }
-        if (module_dom->tx_bias_low_warning_threshold) {
-            smap_add(&pm_info, "tx_bias_low_warning_threshold", module_dom->tx_bias_low_warning_threshold);
-        }
-
-        if (module_dom->rx_power) {
-            smap_add(&pm_info, "rx_power", module_dom->rx_power);
-        }
-        if (module_dom->rx_power_high_alarm) {
-            smap_add(&pm_info, "rx_power_high_alarm", module_dom->rx_power_high_alarm);
-        }
-        if (module_dom->rx_power_low_alarm) {
-            smap_add(&pm_info, "rx_power_low_alarm", module_dom->rx_power_low_alarm);
-        }
-        if (module_dom->rx_power_high_warning) {
-            smap_add(&pm_info, "rx_power_high_warning", module_dom->rx_power_high_warning);
-        }
-        if (module_dom->rx_power_low_warning) {
-            smap_add(&pm_info, "rx_power_low_warning", module_dom->rx_power_low_warning);
-        }
-        if (module_dom->rx_power_high_alarm_threshold) {
-            smap_add(&pm_info, "rx_power_high_alarm_threshold", module_dom->rx_power_high_alarm_threshold);
-        }
-        if (module_dom->rx_power_low_alarm_threshold) {
-            smap_add(&pm_info, "rx_power_low_alarm_threshold", module_dom->rx_power_low_alarm_threshold);
-        }
-        if (module_dom->rx_power_high_warning_threshold) {
-            smap_add(&pm_info, "rx_power_high_warning_threshold", module_dom->rx_power_high_warning_threshold);
-        }
-        if (module_dom->rx_power_low_warning_threshold) {
-            smap_add(&pm_info, "rx_power_low_warning_threshold", module_dom->rx_power_low_warning_threshold);
-        }
-
-        if (module_dom->tx_power) {
-            smap_add(&pm_info, "tx_power", module_dom->tx_power);
-        }
-        if (module_dom->rx_power_high_alarm) {
-            smap_add(&pm_info, "tx_power_high_alarm", module_dom->tx_power_high_alarm);
-        }
-        if (module_dom->tx_power_low_alarm) {
-            smap_add(&pm_info, "tx_power_low_alarm", module_dom->tx_power_low_alarm);
-        }
-        if (module_dom->tx_power_high_warning) {
-            smap_add(&pm_info, "tx_power_high_warning", module_dom->tx_power_high_warning);
-        }
-        if (module_dom->tx_power_low_warning) {
-            smap_add(&pm_info, "tx_power_low_warning", module_dom->tx_power_low_warning);
-        }
-        if (module_dom->tx_power_high_alarm_threshold) {
-            smap_add(&pm_info, "tx_power_high_alarm_threshold", module_dom->tx_power_high_alarm_threshold);
-        }
-        if (module_dom->tx_power_low_alarm_threshold) {
-            smap_add(&pm_info, "tx_power_low_alarm_threshold", module_dom->tx_power_low_alarm_threshold);
-        }
-        if (module_dom->tx_power_high_warning_threshold) {
-            smap_add(&pm_info, "tx_power_high_warning_threshold", module_dom->tx_power_high_warning_threshold);
-        }
-        if (module_dom->tx_power_low_warning_threshold) {
-            smap_add(&pm_info, "tx_power_low_warning_threshold", module_dom->tx_power_low_warning_threshold);
-        }
-
+    pm_dom_to_smap(&port->cold->dom, pm_info);
+*/
+}
 
+#ifdef HAVE_OVSDB_IDL_PARTIAL_MAP
+//
+// pm_info_put: write one pm_info key of an interface, or delete it if the
+//              value is NULL
+//
+// Nothing is written if the replica already has the value (or doesn't have
+// the key to delete).
+//
+static void
+pm_info_put(const char *key, const char *value, void *intf_)
+{
+    const struct ovsrec_interface *intf = intf_;
+    const char *current = smap_get(&intf->pm_info, key);
 
-        if (module_dom->tx1_bias) {
-            smap_add(&pm_info, "tx1_bias", module_dom->tx1_bias);
-        }
-        if (module_dom->rx1_power) {
-            smap_add(&pm_info, "rx1_power", module_dom->rx1_power);
+    if (NULL != value) {
+        if (NULL == current || 0 != strcmp(current, value)) {
+            ovsrec_interface_update_pm_info_setkey(intf, key, value);
         }
+    } else if (NULL != current) {
+        ovsrec_interface_update_pm_info_delkey(intf, key);
+    }
+}
+#endif
+
+//
+// pm_info_write: write the pm_info keys of a port that have changed
+//
+// input: port structure, interface row
+//
+// output: none
+//
+// The first write of a port compares the whole map with the replica, so
+// keys left over from before the daemon started (or the row was reloaded)
+// are deleted, and data the database already holds isn't written again.
+// After that, only the changed keys are compared. Differences are sent as
+// partial map updates.
+//
+// Partial map updates need an OVS 2.6 or later IDL. Without them, the whole
+// map is compared with the replica and written if it differs.
+//
+static void
+pm_info_write(pm_port_t *port, const struct ovsrec_interface *intf)
+{
+    pm_port_cold_t *cold = port->cold;
+#ifdef HAVE_OVSDB_IDL_PARTIAL_MAP
+    size_t idx;
 
-        if (module_dom->tx1_bias_high_alarm) {
-            smap_add(&pm_info, "tx1_bias_high_alarm", module_dom->tx1_bias_high_alarm);
-        }
-        if (module_dom->tx1_bias_low_alarm) {
-            smap_add(&pm_info, "tx1_bias_low_alarm", module_dom->tx1_bias_low_alarm);
-        }
-        if (module_dom->tx1_bias_high_warning) {
-            smap_add(&pm_info, "tx1_bias_high_warning", module_dom->tx1_bias_high_warning);
-        }
-        if (module_dom->tx1_bias_low_warning) {
-            smap_add(&pm_info, "tx1_bias_low_warning", module_dom->tx1_bias_low_warning);
-        }
-        if (module_dom->tx1_bias_high_alarm_threshold) {
-            smap_add(&pm_info, "tx1_bias_high_alarm_threshold", module_dom->tx1_bias_high_alarm_threshold);
-        }
-        if (module_dom->tx1_bias_low_alarm_threshold) {
-            smap_add(&pm_info, "tx1_bias_low_alarm_threshold", module_dom->tx1_bias_low_alarm_threshold);
-        }
-        if (module_dom->tx1_bias_high_warning_threshold) {
-            smap_add(&pm_info, "tx1_bias_high_warning_threshold", module_dom->tx1_bias_high_warning_threshold);
-        }
-        if (module_dom->tx1_bias_low_warning_threshold) {
-            smap_add(&pm_info, "tx1_bias_low_warning_threshold", module_dom->tx1_bias_low_warning_threshold);
-        }
+    if (!cold->pm_info_synced) {
+        struct smap pm_info;
+        struct smap_node *node;
 
-        if (module_dom->rx1_power_high_alarm) {
-            smap_add(&pm_info, "rx1_power_high_alarm", module_dom->rx1_power_high_alarm);
-        }
-        if (module_dom->rx1_power_low_alarm) {
-            smap_add(&pm_info, "rx1_power_low_alarm", module_dom->rx1_power_low_alarm);
-        }
-        if (module_dom->rx1_power_high_warning) {
-            smap_add(&pm_info, "rx1_power_high_warning", module_dom->rx1_power_high_warning);
-        }
-        if (module_dom->rx1_power_low_warning) {
-            smap_add(&pm_info, "rx1_power_low_warning", module_dom->rx1_power_low_warning);
-        }
-        if (module_dom->rx1_power_high_alarm_threshold) {
-            smap_add(&pm_info, "rx1_power_high_alarm_threshold", module_dom->rx1_power_high_alarm_threshold);
-        }
-        if (module_dom->rx1_power_low_alarm_threshold) {
-            smap_add(&pm_info, "rx1_power_low_alarm_threshold", module_dom->rx1_power_low_alarm_threshold);
+        smap_init(&pm_info);
+        pm_info_to_smap(port, &pm_info);
+        SMAP_FOR_EACH(node, &pm_info) {
+            pm_info_put(node->key, node->value, (void *)intf);
         }
-        if (module_dom->rx1_power_high_warning_threshold) {
-            smap_add(&pm_info, "rx1_power_high_warning_threshold", module_dom->rx1_power_high_warning_threshold);
+        SMAP_FOR_EACH(node, &intf->pm_info) {
+            if (NULL == smap_get(&pm_info, node->key)) {
+                pm_info_put(node->key, NULL, (void *)intf);
+            }
         }
-        if (module_dom->rx1_power_low_warning_threshold) {
-            smap_add(&pm_info, "rx1_power_low_warning_threshold", module_dom->rx1_power_low_warning_threshold);
+        smap_destroy(&pm_info);
+    } else {
+        for (idx = 0; idx < PM_INFO_N_FIELDS; idx++) {
+            if (NULL != pm_info_keys[idx] &&
+                (cold->pm_info_dirty & (1u << idx))) {
+                pm_info_put(pm_info_keys[idx], pm_info_field(port, idx),
+                            (void *)intf);
+            }
         }
 
+        // Update diagnostics key values
+/*
+        pm_dom_render_changes(&cold->dom, cold->dom_dirty, pm_info_put,
+                              (void *)intf);
+*/
+    }
+#else
+    struct smap pm_info;
 
+    smap_init(&pm_info);
+    pm_info_to_smap(port, &pm_info);
+    if (!smap_equal(&pm_info, &intf->pm_info)) {
+        ovsrec_interface_set_pm_info(intf, &pm_info);
+    }
+    smap_destroy(&pm_info);
+#endif
+
+    // keep what this transaction writes, in case it fails
+    cold->pm_info_pending = cold->pm_info_dirty;
+    cold->dom_pending = cold->dom_dirty;
+    cold->pm_info_dirty = 0;
+    cold->dom_dirty = 0;
+}
 
-        if (module_dom->tx2_bias) {
-            smap_add(&pm_info, "tx2_bias", module_dom->tx2_bias);
-        }
-        if (module_dom->rx2_power) {
-            smap_add(&pm_info, "rx2_power", module_dom->rx2_power);
-        }
+//
+// pm_ovsdb_txn_done: handle the result of a completed transaction
+//
+// Ports written by a failed transaction are marked as changed again, with
+// the keys the transaction wrote, so their latest data is written by the
+// next transaction.
+//
+static void
+pm_ovsdb_txn_done(enum ovsdb_idl_txn_status status)
+{
+    pm_port_cold_t *cold;
+    pm_port_t *port;
+    bool failed;
 
-        if (module_dom->tx2_bias_high_alarm) {
-            smap_add(&pm_info, "tx2_bias_high_alarm", module_dom->tx2_bias_high_alarm);
-        }
-        if (module_dom->tx2_bias_low_alarm) {
-            smap_add(&pm_info, "tx2_bias_low_alarm", module_dom->tx2_bias_low_alarm);
-        }
-        if (module_dom->tx2_bias_high_warning) {
-            smap_add(&pm_info, "tx2_bias_high_warning", module_dom->tx2_bias_high_warning);
-        }
-        if (module_dom->tx2_bias_low_warning) {
-            smap_add(&pm_info, "tx2_bias_low_warning", module_dom->tx2_bias_low_warning);
-        }
-        if (module_dom->tx2_bias_high_alarm_threshold) {
-            smap_add(&pm_info, "tx2_bias_high_alarm_threshold", module_dom->tx2_bias_high_alarm_threshold);
-        }
-        if (module_dom->tx2_bias_low_alarm_threshold) {
-            smap_add(&pm_info, "tx2_bias_low_alarm_threshold", module_dom->tx2_bias_low_alarm_threshold);
-        }
-        if (module_dom->tx2_bias_high_warning_threshold) {
-            smap_add(&pm_info, "tx2_bias_high_warning_threshold", module_dom->tx2_bias_high_warning_threshold);
-        }
-        if (module_dom->tx2_bias_low_warning_threshold) {
-            smap_add(&pm_info, "tx2_bias_low_warning_threshold", module_dom->tx2_bias_low_warning_threshold);
-        }
+    failed = (TXN_SUCCESS != status && TXN_UNCHANGED != status);
 
-        if (module_dom->rx2_power_high_alarm) {
-            smap_add(&pm_info, "rx2_power_high_alarm", module_dom->rx2_power_high_alarm);
-        }
-        if (module_dom->rx2_power_low_alarm) {
-            smap_add(&pm_info, "rx2_power_low_alarm", module_dom->rx2_power_low_alarm);
-        }
-        if (module_dom->rx2_power_high_warning) {
-            smap_add(&pm_info, "rx2_power_high_warning", module_dom->rx2_power_high_warning);
-        }
-        if (module_dom->rx2_power_low_warning) {
-            smap_add(&pm_info, "rx2_power_low_warning", module_dom->rx2_power_low_warning);
-        }
-        if (module_dom->rx2_power_high_alarm_threshold) {
-            smap_add(&pm_info, "rx2_power_high_alarm_threshold", module_dom->rx2_power_high_alarm_threshold);
-        }
-        if (module_dom->rx2_power_low_alarm_threshold) {
-            smap_add(&pm_info, "rx2_power_low_alarm_threshold", module_dom->rx2_power_low_alarm_threshold);
-        }
-        if (module_dom->rx2_power_high_warning_threshold) {
-            smap_add(&pm_info, "rx2_power_high_warning_threshold", module_dom->rx2_power_high_warning_threshold);
-        }
-        if (module_dom->rx2_power_low_warning_threshold) {
-            smap_add(&pm_info, "rx2_power_low_warning_threshold", module_dom->rx2_power_low_warning_threshold);
-        }
+    if (failed) {
+        static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
 
+        VLOG_WARN_RL(&rl, "pm_info update failed (%s), retrying",
+                     ovsdb_idl_txn_status_to_string(status));
+    }
 
+    LIST_FOR_EACH_POP (cold, txn_node, &pm_txn_ports) {
+        port = cold->port;
+        port->txn_pending = false;
+        if (failed) {
+            cold->pm_info_dirty |= cold->pm_info_pending;
+            cold->dom_dirty |= cold->dom_pending;
+            pm_port_changed(port);
+        } else {
+            cold->pm_info_synced = true;
+        }
+        cold->pm_info_pending = 0;
+        cold->dom_pending = 0;
+    }
 
-        if (module_dom->tx3_bias) {
-            smap_add(&pm_info, "tx3_bias", module_dom->tx3_bias);
-        }
-        if (module_dom->rx3_power) {
-            smap_add(&pm_info, "rx3_power", module_dom->rx3_power);
-        }
+    if (cur_hw_pending) {
+        cur_hw_pending = false;
+        cur_hw_set = !failed;
+    }
+}
 
-        if (module_dom->tx3_bias_high_alarm) {
-            smap_add(&pm_info, "tx3_bias_high_alarm", module_dom->tx3_bias_high_alarm);
-        }
-        if (module_dom->tx3_bias_low_alarm) {
-            smap_add(&pm_info, "tx3_bias_low_alarm", module_dom->tx3_bias_low_alarm);
-        }
-        if (module_dom->tx3_bias_high_warning) {
-            smap_add(&pm_info, "tx3_bias_high_warning", module_dom->tx3_bias_high_warning);
-        }
-        if (module_dom->tx3_bias_low_warning) {
-            smap_add(&pm_info, "tx3_bias_low_warning", module_dom->tx3_bias_low_warning);
-        }
-        if (module_dom->tx3_bias_high_alarm_threshold) {
-            smap_add(&pm_info, "tx3_bias_high_alarm_threshold", module_dom->tx3_bias_high_alarm_threshold);
-        }
-        if (module_dom->tx3_bias_low_alarm_threshold) {
-            smap_add(&pm_info, "tx3_bias_low_alarm_threshold", module_dom->tx3_bias_low_alarm_threshold);
-        }
-        if (module_dom->tx3_bias_high_warning_threshold) {
-            smap_add(&pm_info, "tx3_bias_high_warning_threshold", module_dom->tx3_bias_high_warning_threshold);
-        }
-        if (module_dom->tx3_bias_low_warning_threshold) {
-            smap_add(&pm_info, "tx3_bias_low_warning_threshold", module_dom->tx3_bias_low_warning_threshold);
-        }
+//
+// pm_ovsdb_update: write changed pluggable module data to the database
+//
+// input: none
+//
+// output: none
+//
+// Transactions are committed without blocking. While one is in flight,
+// further changes accumulate in the ports and are written by the next one.
+// Only the ports in the changed port list are visited. A transaction is
+// created only for a port with an interface row to write, or to set cur_hw
+// in the daemon row.
+//
+void
+pm_ovsdb_update(void)
+{
+    struct ovsdb_idl_txn *txn = NULL;
+    enum ovsdb_idl_txn_status status;
+    const struct ovsrec_interface *intf;
+    const struct ovsrec_daemon *db_daemon;
+    pm_port_t   *port = NULL;
+    pm_port_cold_t *cold;
+    struct ovs_list no_intf_ports = OVS_LIST_INITIALIZER(&no_intf_ports);
 
-        if (module_dom->rx3_power_high_alarm) {
-            smap_add(&pm_info, "rx3_power_high_alarm", module_dom->rx3_power_high_alarm);
-        }
-        if (module_dom->rx3_power_low_alarm) {
-            smap_add(&pm_info, "rx3_power_low_alarm", module_dom->rx3_power_low_alarm);
-        }
-        if (module_dom->rx3_power_high_warning) {
-            smap_add(&pm_info, "rx3_power_high_warning", module_dom->rx3_power_high_warning);
-        }
-        if (module_dom->rx3_power_low_warning) {
-            smap_add(&pm_info, "rx3_power_low_warning", module_dom->rx3_power_low_warning);
-        }
-        if (module_dom->rx3_power_high_alarm_threshold) {
-            smap_add(&pm_info, "rx3_power_high_alarm_threshold", module_dom->rx3_power_high_alarm_threshold);
-        }
-        if (module_dom->rx3_power_low_alarm_threshold) {
-            smap_add(&pm_info, "rx3_power_low_alarm_threshold", module_dom->rx3_power_low_alarm_threshold);
-        }
-        if (module_dom->rx3_power_high_warning_threshold) {
-            smap_add(&pm_info, "rx3_power_high_warning_threshold", module_dom->rx3_power_high_warning_threshold);
-        }
-        if (module_dom->rx3_power_low_warning_threshold) {
-            smap_add(&pm_info, "rx3_power_low_warning_threshold", module_dom->rx3_power_low_warning_threshold);
+    if (NULL != pm_txn) {
+        status = ovsdb_idl_txn_commit(pm_txn);
+        if (TXN_INCOMPLETE == status) {
+            return;
         }
+        pm_ovsdb_txn_done(status);
+        ovsdb_idl_txn_destroy(pm_txn);
+        pm_txn = NULL;
+    }
 
+    if (!pm_port_any_changed() && cur_hw_set) {
+        return;
+    }
 
+    // Update pluggable module info in the database for the ports that
+    // have changed. Taking a port off the list clears its module info
+    // update status, until the transaction is done.
+    while (NULL != (port = pm_port_pop_changed())) {
+        intf = pm_port_intf(port);
+        if (NULL == intf) {
+            static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
 
-        if (module_dom->tx4_bias) {
-            smap_add(&pm_info, "tx4_bias", module_dom->tx4_bias);
-        }
-        if (module_dom->rx4_power) {
-            smap_add(&pm_info, "rx4_power", module_dom->rx4_power);
+            VLOG_ERR_RL(&rl, "No DB entry found for hw interface %s\n",
+                        port->instance);
+            list_push_back(&no_intf_ports, &port->cold->changed_node);
+            continue;
         }
 
-        if (module_dom->tx4_bias_high_alarm) {
-            smap_add(&pm_info, "tx4_bias_high_alarm", module_dom->tx4_bias_high_alarm);
-        }
-        if (module_dom->tx4_bias_low_alarm) {
-            smap_add(&pm_info, "tx4_bias_low_alarm", module_dom->tx4_bias_low_alarm);
-        }
-        if (module_dom->tx4_bias_high_warning) {
-            smap_add(&pm_info, "tx4_bias_high_warning", module_dom->tx4_bias_high_warning);
-        }
-        if (module_dom->tx4_bias_low_warning) {
-            smap_add(&pm_info, "tx4_bias_low_warning", module_dom->tx4_bias_low_warning);
-        }
-        if (module_dom->tx4_bias_high_alarm_threshold) {
-            smap_add(&pm_info, "tx4_bias_high_alarm_threshold", module_dom->tx4_bias_high_alarm_threshold);
-        }
-        if (module_dom->tx4_bias_low_alarm_threshold) {
-            smap_add(&pm_info, "tx4_bias_low_alarm_threshold", module_dom->tx4_bias_low_alarm_threshold);
-        }
-        if (module_dom->tx4_bias_high_warning_threshold) {
-            smap_add(&pm_info, "tx4_bias_high_warning_threshold", module_dom->tx4_bias_high_warning_threshold);
-        }
-        if (module_dom->tx4_bias_low_warning_threshold) {
-            smap_add(&pm_info, "tx4_bias_low_warning_threshold", module_dom->tx4_bias_low_warning_threshold);
+        if (NULL == txn) {
+            txn = ovsdb_idl_txn_create(idl);
         }
 
-        if (module_dom->rx4_power_high_alarm) {
-            smap_add(&pm_info, "rx4_power_high_alarm", module_dom->rx4_power_high_alarm);
-        }
-        if (module_dom->rx4_power_low_alarm) {
-            smap_add(&pm_info, "rx4_power_low_alarm", module_dom->rx4_power_low_alarm);
-        }
-        if (module_dom->rx4_power_high_warning) {
-            smap_add(&pm_info, "rx4_power_high_warning", module_dom->rx4_power_high_warning);
-        }
-        if (module_dom->rx4_power_low_warning) {
-            smap_add(&pm_info, "rx4_power_low_warning", module_dom->rx4_power_low_warning);
-        }
-        if (module_dom->rx4_power_high_alarm_threshold) {
-            smap_add(&pm_info, "rx4_power_high_alarm_threshold", module_dom->rx4_power_high_alarm_threshold);
-        }
-        if (module_dom->rx4_power_low_alarm_threshold) {
-            smap_add(&pm_info, "rx4_power_low_alarm_threshold", module_dom->rx4_power_low_alarm_threshold);
-        }
-        if (module_dom->rx4_power_high_warning_threshold) {
-            smap_add(&pm_info, "rx4_power_high_warning_threshold", module_dom->rx4_power_high_warning_threshold);
-        }*/
-        if (module_dom) {
-            ;//smap_add(&pm_info, "rx4_power_low_warning_threshold", module_dom->rx4_power_low_warning_threshold);
-        }
+        // Set changed pm_info keys
+        pm_info_write(port, intf);
 
-        ovsrec_interface_set_pm_info(intf, &pm_info);
-        smap_destroy(&pm_info);
+        port->txn_pending = true;
+        list_push_back(&pm_txn_ports, &port->cold->txn_node);
+    }
 
-        // Clear port's module info update status
-        port->module_info_changed = false;
+    // Ports without an interface row keep their changes, they are written
+    // once the row is replicated.
+    LIST_FOR_EACH_POP (cold, changed_node, &no_intf_ports) {
+        pm_port_changed(cold->port);
     }
-          
+
     if (!cur_hw_set) {
         OVSREC_DAEMON_FOR_EACH(db_daemon, idl) {
         	  if (strcmp(db_daemon->name, NAME_IN_DAEMON_TABLE) == 0) {
+                if (NULL == txn) {
+                    txn = ovsdb_idl_txn_create(idl);
+                }
                 ovsrec_daemon_set_cur_hw(db_daemon, (int64_t) 1);
                 VLOG_WARN("%s(%d)started+++++++db_daemon->cur_hw=%d", __FUNCTION__, __LINE__, (int)db_daemon->cur_hw);
-                cur_hw_set = true;
+                cur_hw_pending = true;
                 break;
             }
         }
     }
 
-    ovsdb_idl_txn_commit_block(txn);
+    if (NULL == txn) {
+        return;
+    }
+
+    status = ovsdb_idl_txn_commit(txn);
+    if (TXN_INCOMPLETE == status) {
+        pm_txn = txn;
+        return;
+    }
+
+    pm_ovsdb_txn_done(status);
     ovsdb_idl_txn_destroy(txn);
+}
+
+//
+// pm_ovsdb_wait: wake up when the transaction in flight completes
+//
+void
+pm_ovsdb_wait(void)
+{
+    if (NULL != pm_txn) {
+        ovsdb_idl_txn_wait(pm_txn);
+    }
+}
 
+//
+// pm_ovsdb_exit: abandon the transaction in flight
+//
+void
+pm_ovsdb_exit(void)
+{
+    if (NULL != pm_txn) {
+        ovsdb_idl_txn_destroy(pm_txn);
+        pm_txn = NULL;
+    }
 }
 
 static void
 pmd_free_pm_port(pm_port_t *port)
 {
+    pm_sched_remove_port(port);
+    pm_scan_invalidate();
     pm_delete_all_data(port);
-    free(port->instance);
-    free(port);
+    pm_arena_destroy(port);
+    free(port->cold->subsystem);
+    pm_port_free(port);
 }
 
 static int
@@ -689,12 +578,53 @@ pm_daemon_subscribe(void)
     return 0;
 }
 
+//
+// pm_intf_condition_update: limit the Interface rows replicated to the ones
+//                           that can be pluggable ports
+//
+// input: none
+//
+// output: none
+//
+// Rows of type system, and rows named after a pluggable port of a managed
+// subsystem, are monitored. Internal, bridge, VLAN and LAG interfaces are
+// never pluggable and aren't replicated.
+//
+// Monitor conditions need an OVS 2.7 or later IDL. Without them, all
+// Interface rows are replicated.
+//
+static void
+pm_intf_condition_update(void)
+{
+#ifdef HAVE_OVSDB_IDL_CONDITION
+    struct ovsdb_idl_condition cond = OVSDB_IDL_CONDITION_INIT(&cond);
+    struct shash_node *sub_node;
+    struct shash_node *port_node;
+    const YamlPort *yaml_port;
+
+    ovsrec_interface_add_clause_type(&cond, OVSDB_F_EQ,
+                                     OVSREC_INTERFACE_TYPE_SYSTEM);
+
+    SHASH_FOR_EACH(sub_node, &ovs_subs) {
+        SHASH_FOR_EACH(port_node, pm_get_yaml_ports(sub_node->name)) {
+            yaml_port = port_node->data;
+            if (yaml_port->pluggable) {
+                ovsrec_interface_add_clause_name(&cond, OVSDB_F_EQ,
+                                                 yaml_port->name);
+            }
+        }
+    }
+
+    ovsdb_idl_set_condition(idl, &ovsrec_table_interface, &cond);
+    ovsdb_idl_condition_destroy(&cond);
+#endif
+
+    pm_intf_condition_changed = false;
+}
+
 static int
 pm_intf_subscribe(void)
 {
-    // initialize port data hash
-    shash_init(&ovs_intfs);
-
     ovsdb_idl_add_table(idl, &ovsrec_table_interface);
     ovsdb_idl_add_column(idl, &ovsrec_interface_col_name);
     ovsdb_idl_add_column(idl, &ovsrec_interface_col_pm_info);
@@ -702,6 +632,12 @@ pm_intf_subscribe(void)
 
     ovsdb_idl_add_column(idl, &ovsrec_interface_col_hw_intf_config);
 
+    // track inserted and deleted interfaces, and hw_intf_config changes
+    ovsdb_idl_track_add_column(idl, &ovsrec_interface_col_hw_intf_config);
+
+    // only system interfaces, until subsystems are known
+    pm_intf_condition_update();
+
     return 0;
 }
 
@@ -715,6 +651,9 @@ pm_subsystem_subscribe(void)
     ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_hw_desc_dir);
     ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_interfaces);
 
+    // track inserted and deleted subsystems, and changes to their interfaces
+    ovsdb_idl_track_add_column(idl, &ovsrec_subsystem_col_interfaces);
+
     return 0;
 }
 
@@ -736,8 +675,26 @@ pmd_configure(struct ovsdb_idl *idl)
         ovsdb_if_intf_configure(intf);
     }
 
+    if (pm_intf_condition_changed) {
+        pm_intf_condition_update();
+    }
+
+    // the rows above are processed, only later changes are of interest
+    ovsdb_idl_track_clear(idl);
 }
 
+//
+// pmd_reconfigure: process database changes
+//
+// input: idl
+//
+// output: none
+//
+// Only the rows that were inserted, deleted or had a tracked column
+// changed since the last call are visited (our own pm_info writes aren't
+// tracked). Deleted rows have no column data left, so deleted interfaces
+// and subsystems are found by uuid.
+//
 void
 pmd_reconfigure(struct ovsdb_idl *idl)
 {
@@ -747,6 +704,8 @@ pmd_reconfigure(struct ovsdb_idl *idl)
     pm_port_t *port;
     struct shash_node *node;
     struct shash_node *next;
+    bool subsys_deleted = false;
+    bool intf_added = false;
 
     if (new_idl_seqno == idl_seqno){
         return;
@@ -754,54 +713,103 @@ pmd_reconfigure(struct ovsdb_idl *idl)
 
     idl_seqno = new_idl_seqno;
 
-    // Process deleted interfaces.
-    SHASH_FOR_EACH_SAFE(node, next, &ovs_intfs) {
-        const struct ovsrec_interface *tmp_if;
-        port = (pm_port_t *) node->data;
+    OVSREC_SUBSYSTEM_FOR_EACH_TRACKED(subsys, idl) {
+        if (ovsrec_subsystem_is_deleted(subsys)) {
+            subsys_deleted = true;
+            break;
+        }
+    }
 
-        tmp_if = ovsrec_interface_get_for_uuid(idl, &port->uuid);
-        if (NULL == tmp_if) {
-            struct shash_node *delete_node;
+    // Process deleted interfaces.
+    OVSREC_INTERFACE_FOR_EACH_TRACKED(intf, idl) {
+        if (!ovsrec_interface_is_deleted(intf)) {
+            continue;
+        }
+        port = pm_port_find_by_uuid(&intf->header_.uuid);
+        if (NULL != port && NULL == pm_port_intf(port)) {
             VLOG_DBG("Deleted Interface %s\n", port->instance);
-            delete_node = shash_find(&ovs_intfs, port->instance);
-            port = (pm_port_t *) delete_node->data;
-            shash_delete(&ovs_intfs, delete_node);
             pmd_free_pm_port(port);
         }
     }
 
     // Process deleted subsystems
-    SHASH_FOR_EACH_SAFE(node, next, &ovs_subs) {
-        const struct ovsrec_subsystem *tmp_sub;
-        struct uuid *uuid;
-
-        uuid = (struct uuid *) node->data;
-
-        tmp_sub = ovsrec_subsystem_get_for_uuid(idl, uuid);
-        if (NULL == tmp_sub) {
-            struct shash_node *delete_node;
-            delete_node = shash_find(&ovs_subs, node->name);
-            VLOG_DBG("Deleted subsystem %s\n", node->name);
-            shash_delete(&ovs_subs, delete_node);
-            free(uuid);
-            // OPS_TODO: remove config subsystem
+    if (subsys_deleted) {
+        SHASH_FOR_EACH_SAFE(node, next, &ovs_subs) {
+            const struct ovsrec_subsystem *tmp_sub;
+            struct uuid *uuid;
+
+            uuid = (struct uuid *) node->data;
+
+            tmp_sub = ovsrec_subsystem_get_for_uuid(idl, uuid);
+            if (NULL == tmp_sub) {
+                struct shash_node *delete_node;
+                delete_node = shash_find(&ovs_subs, node->name);
+                VLOG_DBG("Deleted subsystem %s\n", node->name);
+                pm_yaml_port_index_invalidate(node->name);
+                pm_event_remove_subsystem(node->name);
+                shash_delete(&ovs_subs, delete_node);
+                free(uuid);
+                pm_intf_condition_changed = true;
+                // OPS_TODO: remove config subsystem
+            }
         }
     }
 
-    // Process added/deleted subsystems.
-    OVSREC_SUBSYSTEM_FOR_EACH(subsys, idl) {
-        ovsdb_if_subsys_process(subsys);
+    // Interface rows admitted by a new monitor condition arrive after the
+    // subsystem rows referencing them, which aren't seen as updated then.
+    // A new row of an existing port was reloaded (reconnect), its pm_info
+    // is compared with the port's data again.
+    OVSREC_INTERFACE_FOR_EACH_TRACKED(intf, idl) {
+        if (!ovsrec_interface_is_new(intf) ||
+            ovsrec_interface_is_deleted(intf)) {
+            continue;
+        }
+        port = pm_port_find_by_uuid(&intf->header_.uuid);
+        if (NULL == port) {
+            intf_added = true;
+        } else {
+            port->cold->pm_info_synced = false;
+            pm_port_changed(port);
+        }
+    }
+
+    // Process added subsystems, and interfaces added to subsystems.
+    if (intf_added) {
+        OVSREC_SUBSYSTEM_FOR_EACH(subsys, idl) {
+            ovsdb_if_subsys_process(subsys);
+        }
+    } else {
+        OVSREC_SUBSYSTEM_FOR_EACH_TRACKED(subsys, idl) {
+            if (ovsrec_subsystem_is_deleted(subsys)) {
+                continue;
+            }
+            if (ovsrec_subsystem_is_new(subsys) ||
+                ovsrec_subsystem_is_updated(subsys,
+                                            OVSREC_SUBSYSTEM_COL_INTERFACES)) {
+                ovsdb_if_subsys_process(subsys);
+            }
+        }
     }
 
     // Process modified interfaces.
-    OVSREC_INTERFACE_FOR_EACH(intf, idl) {
-        node = shash_find(&ovs_intfs, intf->name);
-        if (NULL != node) {
-            port = (pm_port_t *) node->data;
+    OVSREC_INTERFACE_FOR_EACH_TRACKED(intf, idl) {
+        if (ovsrec_interface_is_deleted(intf) ||
+            !ovsrec_interface_is_updated(intf,
+                                         OVSREC_INTERFACE_COL_HW_INTF_CONFIG)) {
+            continue;
+        }
+        port = pm_port_find_by_uuid(&intf->header_.uuid);
+        if (NULL != port) {
             // Process modified interface.
             ovsdb_if_intf_modify(intf, port);
         }
     }
+
+    if (pm_intf_condition_changed) {
+        pm_intf_condition_update();
+    }
+
+    ovsdb_idl_track_clear(idl);
 }
 
 int
@@ -836,7 +844,7 @@ pm_interface_dump(struct ds *ds, pm_port_t *port)
 {
     struct ovs_module_info *module;
 
-    module = &port->ovs_module_columns;
+    module = &port->cold->ovs_module_columns;
     ds_put_format(ds, "Pluggable info for Interface %s:\n", port->instance);
     if (module->cable_length) {
         ds_put_format(ds, "    cable_length           = %s\n",
@@ -886,30 +894,25 @@ pm_interface_dump(struct ds *ds, pm_port_t *port)
         ds_put_format(ds, "    vendor_serial_number   = %s\n",
                       module->vendor_serial_number);
     }
+    pm_dom_dump(&port->cold->dom, ds);
 }
 
 static void
 pm_interfaces_dump(struct ds *ds, int argc, const char *argv[])
 {
-    struct shash_node *sh_node;
     pm_port_t *port = NULL;
+    size_t id;
 
     if (argc > 2) {
-        sh_node = shash_find(&ovs_intfs, argv[2]);
-        if (NULL != sh_node) {
-            port = (pm_port_t *)sh_node->data;
-            if (port){
-                pm_interface_dump(ds, port);
-            }
+        port = pm_port_find(argv[2]);
+        if (port){
+            pm_interface_dump(ds, port);
         }
     } else {
         ds_put_cstr(ds, "================ Interfaces ================\n");
 
-        SHASH_FOR_EACH(sh_node, &ovs_intfs) {
-            port = (pm_port_t *)sh_node->data;
-            if (port){
-                pm_interface_dump(ds, port);
-            }
+        PM_PORT_FOR_EACH(port, id) {
+            pm_interface_dump(ds, port);
         }
     }
 }
@@ -929,6 +932,8 @@ pm_debug_dump(struct ds *ds, int argc, const char *argv[])
 
         if (!strcmp(table_name, "interface")) {
             pm_interfaces_dump(ds, argc, argv);
+        } else if (!strcmp(table_name, "strings")) {
+            pm_intern_dump(ds);
         }
     } else {
         pm_interfaces_dump(ds, 0, NULL);
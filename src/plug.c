@@ -31,6 +31,8 @@
 #include <fcntl.h>
 #include <time.h>
 
+#include <timeval.h>
+
 #include <vswitch-idl.h>
 #include <openswitch-idl.h>
 
@@ -40,7 +42,6 @@
 
 VLOG_DEFINE_THIS_MODULE(plug);
 
-extern struct shash ovs_intfs;
 extern YamlConfigHandle global_yaml_handle;
 
 extern int sfpp_sum_verify(unsigned char *);
@@ -51,6 +52,8 @@ extern int pm_parse(pm_sfp_serial_id_t *serial_datap, pm_port_t *port);
  * Functions to retieve DOM information
  */
 extern void pm_set_a2(pm_port_t *port, pm_sfp_dom_t *a2_data);
+extern void pm_set_a2_thresholds(pm_port_t *port,
+                                 const pm_dom_thresholds_t *thresholds);
 extern void set_a2_read_request(pm_port_t *port, pm_sfp_serial_id_t *serial_datap);
 
 /*
@@ -74,12 +77,10 @@ static void pm_reset_port(pm_port_t *port);
 int
 pm_set_enabled(void)
 {
-    struct shash_node *node;
     pm_port_t   *port = NULL;
+    size_t      id;
 
-    SHASH_FOR_EACH(node, &ovs_intfs) {
-        port = (pm_port_t *)node->data;
-
+    PM_PORT_FOR_EACH(port, id) {
         pm_configure_port(port);
     }
 
@@ -96,74 +97,170 @@ void
 pm_delete_all_data(pm_port_t *port)
 {
     DELETE(port, connector_status);
-    DELETE_FREE(port, supported_speeds);
+    DELETE_INTERN(port, supported_speeds);
     DELETE(port, cable_technology);
     DELETE_FREE(port, cable_length);
-    DELETE_FREE(port, max_speed);
+    DELETE_INTERN(port, max_speed);
     DELETE(port, power_mode);
-    DELETE_FREE(port, vendor_name);
-    DELETE_FREE(port, vendor_oui);
-    DELETE_FREE(port, vendor_part_number);
-    DELETE_FREE(port, vendor_revision);
+    DELETE_INTERN(port, vendor_name);
+    DELETE_INTERN(port, vendor_oui);
+    DELETE_INTERN(port, vendor_part_number);
+    DELETE_INTERN(port, vendor_revision);
     DELETE_FREE(port, vendor_serial_number);
     DELETE_FREE(port, a0);
     DELETE_FREE(port, a2);
     DELETE_FREE(port, a0_uppers);
+    pm_dom_clear(port);
+
+    // all strings but the static connector are deleted, release them
+    pm_arena_reset(port);
+}
+
+//
+// pm_build_access_plan: resolve the connector type, devices and signals
+//                       a port's module is accessed with
+//
+// input: port structure
+//
+// output: none
+//
+// This is done once, when the interface is created, and again only if the
+// YAML data for the subsystem changes.
+//
+void
+pm_build_access_plan(pm_port_t *port)
+{
+    pm_access_plan_t    *access = &port->cold->access;
+    const YamlPort      *yaml_port = port->cold->module_device;
+    char                a2_device_name[MAX_DEVICE_NAME_LEN];
+
+    memset(access, 0, sizeof(*access));
+
+    if (false == yaml_port->pluggable || NULL == yaml_port->connector) {
+        access->module_type = MODULE_TYPE_UNKNOWN;
+        return;
+    }
+
+    if (0 == strcmp(yaml_port->connector, CONNECTOR_SFP_PLUS)) {
+        access->module_type = MODULE_TYPE_SFP_PLUS;
+        access->presence_op = yaml_port->module_signals.sfp.sfpp_mod_present;
+        access->tx_disable_op = yaml_port->module_signals.sfp.sfpp_tx_disable;
+        access->serial_id_offset = SFP_SERIAL_ID_OFFSET;
+    } else if (0 == strcmp(yaml_port->connector, CONNECTOR_QSFP_PLUS)) {
+        access->module_type = MODULE_TYPE_QSFP_PLUS;
+        access->presence_op = yaml_port->module_signals.qsfp.qsfpp_mod_present;
+        access->reset_op = yaml_port->module_signals.qsfp.qsfpp_reset;
+        access->serial_id_offset = QSFP_SERIAL_ID_OFFSET;
+    } else if (0 == strcmp(yaml_port->connector, CONNECTOR_QSFP28)) {
+        access->module_type = MODULE_TYPE_QSFP28;
+        access->presence_op =
+            yaml_port->module_signals.qsfp28.qsfp28p_mod_present;
+        access->reset_op = yaml_port->module_signals.qsfp28.qsfp28p_reset;
+        access->serial_id_offset = QSFP_SERIAL_ID_OFFSET;
+    } else {
+        VLOG_WARN("unknown connector type for port: %s (%s)",
+                  port->instance, yaml_port->connector);
+        access->module_type = MODULE_TYPE_UNKNOWN;
+        return;
+    }
+
+    // get device for module eeprom
+    access->a0_device = yaml_find_device(global_yaml_handle, port->cold->subsystem,
+                                         yaml_port->module_eeprom);
+
+    // SFP DOM data is on the implied "<eeprom>_dom" device (A2), QSFP DOM
+    // data is in the module eeprom
+    if (MODULE_TYPE_SFP_PLUS == access->module_type) {
+        snprintf(a2_device_name, sizeof(a2_device_name), "%s_dom",
+                 yaml_port->module_eeprom);
+        access->a2_device = yaml_find_device(global_yaml_handle,
+                                             port->cold->subsystem, a2_device_name);
+    } else {
+        access->a2_device = access->a0_device;
+    }
+}
+
+#ifndef PLATFORM_SIMULATION
+// module present signals, read once per register for all ports
+static struct pm_signal_set *presence_signals = NULL;
+
+//
+// pm_presence_op: get the module present operation for a port
+//
+static const i2c_bit_op *
+pm_presence_op(const pm_port_t *port)
+{
+    return port->cold->access.presence_op;
+}
+#endif
+
+//
+// pm_read_presence: read the module present signals for all ports
+//
+// input: none
+//
+// output: none
+//
+void
+pm_read_presence(void)
+{
+#ifndef PLATFORM_SIMULATION
+    if (NULL == presence_signals) {
+        presence_signals = pm_signal_set_create("module presence",
+                                                pm_presence_op);
+    }
+
+    pm_signal_set_read(presence_signals);
+#endif
+}
+
+//
+// pm_presence_invalidate: regroup presence signals on the next read
+//
+void
+pm_presence_invalidate(void)
+{
+#ifndef PLATFORM_SIMULATION
+    if (NULL != presence_signals) {
+        pm_signal_set_invalidate(presence_signals);
+    }
+#endif
+}
+
+//
+// pm_presence_destroy: free the presence signal groups
+//
+void
+pm_presence_destroy(void)
+{
+#ifndef PLATFORM_SIMULATION
+    pm_signal_set_destroy(presence_signals);
+    presence_signals = NULL;
+#endif
 }
 
 static bool
 pm_get_presence(pm_port_t *port)
 {
 #ifdef PLATFORM_SIMULATION
-    if (NULL != port->module_data) {
+    if (NULL != port->cold->module_data) {
         return true;
     }
     return false;
 #else
-    // presence detection data
-    bool                present;
     uint32_t            result;
+    int                 rc;
 
-    int rc;
-
-    // i2c interface structures
-    i2c_bit_op *        reg_op;
-
-    // retry up to 5 times if data is invalid or op fails
-    int                 retry_count = 2;
-
-    if (0 == strcmp(port->module_device->connector, CONNECTOR_SFP_PLUS)) {
-        reg_op = port->module_device->module_signals.sfp.sfpp_mod_present;
-    } else if (0 == strcmp(port->module_device->connector,
-                           CONNECTOR_QSFP_PLUS)) {
-        reg_op = port->module_device->module_signals.qsfp.qsfpp_mod_present;
-    } else if (0 == strcmp(port->module_device->connector,
-                           CONNECTOR_QSFP28)) {
-        reg_op = port->module_device->module_signals.qsfp28.qsfp28p_mod_present;
-    } else {
-        VLOG_ERR("port is not pluggable: %s", port->instance);
-        return false;
-    }
-retry_read:
-
-    // execute the operation
-    rc = i2c_reg_read(global_yaml_handle, port->subsystem, reg_op, &result);
+    // use the value from the last pm_read_presence
+    rc = pm_signal_get(presence_signals, port, &result);
 
     if (rc != 0) {
-        if (retry_count != 0) {
-            VLOG_WARN("module presence read failed, retrying: %s",
-                      port->instance);
-            retry_count--;
-            goto retry_read;
-        }
         VLOG_ERR("unable to read module presence: %s", port->instance);
         return false;
     }
 
     // calculate presence
-    present = (result != 0);
-
-    return present;
+    return (result != 0);
 #endif
 }
 
@@ -171,20 +268,14 @@ static int
 pm_read_a0(pm_port_t *port, unsigned char *data, size_t offset)
 {
 #ifdef PLATFORM_SIMULATION
-    memcpy(data, port->module_data, sizeof(pm_sfp_serial_id_t));
+    memcpy(data, port->cold->module_data, sizeof(pm_sfp_serial_id_t));
     return 0;
 #else
-    // device data
-    const YamlDevice *device;
-
     int                 rc;
 
     // OPS_TODO: Need to read ready bit for QSFP modules (?)
 
-    // get device for module eeprom
-    device = yaml_find_device(global_yaml_handle, port->subsystem, port->module_device->module_eeprom);
-
-    rc = i2c_data_read(global_yaml_handle, device, port->subsystem, offset,
+    rc = i2c_data_read(global_yaml_handle, port->cold->access.a0_device, port->cold->subsystem, offset,
                        sizeof(pm_sfp_serial_id_t), data);
 
     if (rc != 0) {
@@ -196,35 +287,108 @@ pm_read_a0(pm_port_t *port, unsigned char *data, size_t offset)
 #endif
 }
 
+//
+// pm_read_a2: read part of the DOM data of a module
+//
+// input: port structure, DOM data buffer, offset and length to read
+//
+// output: 0 on success, -1 on failure
+//
+// The data is read into a2_data at the same offset it has in the module.
+//
 static int
-pm_read_a2(pm_port_t *port, unsigned char *a2_data)
+pm_read_a2(pm_port_t *port, unsigned char *a2_data, size_t offset,
+           size_t len)
 {
 #ifdef PLATFORM_SIMULATION
     return -1;
 #else
-    // device data
-    const YamlDevice    *device;
+    const YamlDevice    *device = port->cold->access.a2_device;
 
     int                 rc;
-    char                a2_device_name[MAX_DEVICE_NAME_LEN];
 
-    VLOG_DBG("Read A2 address from yaml files.");
-    if (strcmp(port->module_device->connector, CONNECTOR_SFP_PLUS) == 0) {
-        strncpy(a2_device_name, port->module_device->module_eeprom, MAX_DEVICE_NAME_LEN);
-        strncat(a2_device_name, "_dom", MAX_DEVICE_NAME_LEN);
+    if (NULL == device) {
+        VLOG_DBG("no dom device: %s", port->instance);
+        return -1;
     }
-    else {
-        strncpy(a2_device_name, port->module_device->module_eeprom, MAX_DEVICE_NAME_LEN);
+
+    rc = i2c_data_read(global_yaml_handle, device, port->cold->subsystem, offset,
+                       len, a2_data + offset);
+
+    if (rc != 0) {
+        VLOG_ERR("module dom read failed: %s", port->instance);
+        return -1;
     }
 
-    // get constructed A2 device
-    device = yaml_find_device(global_yaml_handle, port->subsystem, a2_device_name);
+    return 0;
+#endif
+}
+
+//
+// pm_read_dom_thresholds: read the DOM alarm and warning thresholds
+//
+// input: port structure, threshold buffer
+//
+// output: 0 on success, -1 on failure
+//
+// QSFP thresholds are on upper page 3, which is selected for the read and
+// deselected again afterwards. Flat memory modules don't have them.
+//
+static int
+pm_read_dom_thresholds(pm_port_t *port, pm_dom_thresholds_t *thresholds)
+{
+#ifdef PLATFORM_SIMULATION
+    return -1;
+#else
+    const YamlDevice    *device = port->cold->access.a2_device;
+    unsigned char       status;
+    unsigned char       page;
+    int                 rc;
+
+    if (NULL == device) {
+        VLOG_DBG("no dom device: %s", port->instance);
+        return -1;
+    }
 
-    rc = i2c_data_read(global_yaml_handle, device, port->subsystem, 0,
-                       sizeof(pm_sfp_dom_t), a2_data);
+    if (MODULE_TYPE_SFP_PLUS == port->cold->access.module_type) {
+        rc = i2c_data_read(global_yaml_handle, device, port->cold->subsystem,
+                           SFP_DOM_THRESHOLDS_OFFSET,
+                           sizeof(thresholds->sfp), thresholds->sfp);
+        goto end;
+    }
 
+    rc = i2c_data_read(global_yaml_handle, device, port->cold->subsystem,
+                       QSFP_STATUS_OFFSET, sizeof(status), &status);
     if (rc != 0) {
-        VLOG_ERR("module dom read failed: %s", port->instance);
+        goto end;
+    }
+
+    if (status & QSFP_STATUS_FLAT_MEM) {
+        VLOG_DBG("module has no threshold page: %s", port->instance);
+        return -1;
+    }
+
+    page = QSFP_THRESHOLDS_PAGE;
+    rc = i2c_data_write(global_yaml_handle, device, port->cold->subsystem,
+                        QSFP_PAGE_SELECT_OFFSET, sizeof(page), &page);
+    if (rc != 0) {
+        goto end;
+    }
+
+    rc = i2c_data_read(global_yaml_handle, device, port->cold->subsystem,
+                       QSFP_DOM_THRESHOLDS_OFFSET, sizeof(thresholds->qsfp),
+                       (unsigned char *)&thresholds->qsfp);
+
+    // the serial id data is on page 0, always go back to it
+    page = 0;
+    if (i2c_data_write(global_yaml_handle, device, port->cold->subsystem,
+                       QSFP_PAGE_SELECT_OFFSET, sizeof(page), &page) != 0) {
+        VLOG_WARN("unable to restore page 0: %s", port->instance);
+    }
+
+end:
+    if (rc != 0) {
+        VLOG_ERR("module dom threshold read failed: %s", port->instance);
         return -1;
     }
 
@@ -233,58 +397,141 @@ pm_read_a2(pm_port_t *port, unsigned char *a2_data)
 }
 
 //
-// pm_read_module_state: read the presence and id page for a pluggable module
+// pm_read_module_io: read the presence, id page and a2 page for a pluggable
+//                    module into the port's scan result
 //
 // input: port structure
 //
-// output: success 0, failure !0
+// output: none
+//
+// note: this is called by the scan engine, possibly from a bus worker thread.
+//       It must only access the hardware and port->cold->scan; all processing of
+//       the data is done by pm_read_module_update on the main thread.
 //
 // OPS_TODO: this code needs to be refactored to simplify and clarify
-int
-pm_read_module_state(pm_port_t *port)
+void
+pm_read_module_io(pm_port_t *port)
 {
     int             rc;
 
-    // presence detection data
-    bool            present;
-
-    // serial id data (SFP+ structure)
-    pm_sfp_serial_id_t a0;
-
-    // a2 page is for SFP+, only
-    pm_sfp_dom_t a2;
-    // unsigned char   a2[PM_SFP_A2_PAGE_SIZE];
+    pm_scan_result_t *scan = &port->cold->scan;
 
     // retry up to 2 times if data is invalid or op fails
     int             retry_count = 2;
-    unsigned char   offset;
 
-    memset(&a0, 0, sizeof(a0));
-    memset(&a2, 0, sizeof(a2));
+    // tasks the scheduler has marked as due for the port
+    unsigned int    due = port->sched_due;
 
-    // SFP+ and QSFP serial id data are at different offsets
-    // take this opportunity to get the correct presence detection operation
+    size_t          live_offset;
+    size_t          live_len;
 
-    if (0 == strcmp(port->module_device->connector, CONNECTOR_SFP_PLUS)) {
-        offset = SFP_SERIAL_ID_OFFSET;
-    } else if ((0 == strcmp(port->module_device->connector,
-                            CONNECTOR_QSFP_PLUS)) ||
-               (0 == strcmp(port->module_device->connector,
-                            CONNECTOR_QSFP28))) {
-        offset = QSFP_SERIAL_ID_OFFSET;
-    } else {
+    memset(scan, 0, sizeof(*scan));
+
+    if (MODULE_TYPE_UNKNOWN == port->cold->access.module_type) {
         VLOG_ERR("port is not pluggable: %s", port->instance);
-        return -1;
+        return;
+    }
+
+    // a module in reset can't be read, it is scheduled again once it's ready
+    if (PM_RESET_READY != port->reset_state) {
+        return;
+    }
+
+    if (due & PM_TASK_BIT(PM_TASK_PRESENCE)) {
+        scan->present = pm_get_presence(port);
+    } else {
+        scan->present = port->present;
+    }
+
+    if (!scan->present && false) {
+        scan->valid = true;
+        return;
+    }
+
+    if ((port->present == false && (due & PM_TASK_BIT(PM_TASK_PRESENCE))) ||
+        (port->retry == true && (due & PM_TASK_BIT(PM_TASK_IDENTITY)))) {
+        // haven't read A0 data, yet
+
+        VLOG_DBG("module is present for port: %s", port->instance);
+
+        // SFP+ and QSFP serial id data are at different offsets
+        rc = pm_read_a0(port, (unsigned char *)&scan->a0,
+                        port->cold->access.serial_id_offset);
+
+        scan->a0_read = true;
+        scan->a0_rc = rc;
+    }
+
+    if (port->a2_read_requested == false || true ||
+        0 == (due & (PM_TASK_BIT(PM_TASK_DOM) |
+                     PM_TASK_BIT(PM_TASK_THRESHOLDS)))) {
+        scan->valid = true;
+        return;
+    }
+
+    // thresholds are constant, they are only read once per module
+    if ((due & PM_TASK_BIT(PM_TASK_THRESHOLDS)) &&
+        false == port->dom_thresholds_valid) {
+        scan->thresholds_rc = pm_read_dom_thresholds(port, &scan->thresholds);
+        scan->thresholds_read = true;
+    }
+
+    if (0 == (due & PM_TASK_BIT(PM_TASK_DOM))) {
+        scan->valid = true;
+        return;
+    }
+
+    // live values and flags only
+    if (MODULE_TYPE_SFP_PLUS == port->cold->access.module_type) {
+        live_offset = SFP_DOM_LIVE_OFFSET;
+        live_len = SFP_DOM_LIVE_LEN;
+    } else {
+        live_offset = QSFP_DOM_LIVE_OFFSET;
+        live_len = QSFP_DOM_LIVE_LEN;
+    }
+
+retry_read_a2:
+    rc = pm_read_a2(port, (unsigned char *)&scan->a2, live_offset, live_len);
+
+    if (rc != 0) {
+        if (retry_count != 0) {
+            VLOG_DBG("module a2 read failed, retrying: %s", port->instance);
+            retry_count--;
+            goto retry_read_a2;
+        }
+
+        VLOG_WARN("module a2 read failed: %s", port->instance);
+
+        memset(&scan->a2, 0xff, sizeof(scan->a2));
     }
 
-retry_read:
-    present = pm_get_presence(port);
+    scan->a2_read = true;
+    scan->valid = true;
+}
+
+//
+// pm_read_module_update: process the scan result read by pm_read_module_io
+//
+// input: port structure
+//
+// output: success 0, failure !0
+//
+int
+pm_read_module_update(pm_port_t *port)
+{
+    int             rc;
+
+    pm_scan_result_t *scan = &port->cold->scan;
+
+    if (false == scan->valid) {
+        return -1;
+    }
 
-    if (!present && false) {    
+    if (!scan->present && false) {
         // Update only if the module was previously present or
         // the entry is uninitialized.
         if ((port->present == true) ||
-            (NULL == port->ovs_module_columns.connector)) {
+            (NULL == port->cold->ovs_module_columns.connector)) {
             // delete current data from entry
             port->present = false;
             pm_delete_all_data(port);
@@ -294,23 +541,18 @@ retry_read:
                               OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_UNRECOGNIZED);
             VLOG_DBG("module is not present for port: %s", port->instance);
         }
-        return 0;    
+        return 0;
     }
 
-    if (port->present == false || port->retry == true) {
-        // haven't read A0 data, yet
-
-        VLOG_DBG("module is present for port: %s", port->instance);
-
-        rc = pm_read_a0(port, (unsigned char *)&a0, offset);
-
-        if (rc != 0 && false) {
-            if (retry_count != 0) {
+    if (scan->a0_read) {
+        if (scan->a0_rc != 0 && false) {
+            if (port->reset_retries != 0) {
+                // a0 is read again once the module is out of reset
                 VLOG_DBG("module serial ID data read failed, resetting and retrying: %s",
                          port->instance);
+                port->reset_retries--;
                 pm_reset_port(port);
-                retry_count--;
-                goto retry_read;
+                return -1;
             }
             VLOG_WARN("module serial ID data read failed: %s", port->instance);
             pm_delete_all_data(port);
@@ -324,13 +566,7 @@ retry_read:
 
         /*
         // do checksum validation
-        if (sfpp_sum_verify((unsigned char *)&a0) != 0) {
-            if (retry_count != 0) {
-                VLOG_DBG("module serial ID data failed checksum, resetting and retrying: %s", port->instance);
-                pm_reset_port(port);
-                retry_count--;
-                goto retry_read;
-            }
+        if (sfpp_sum_verify((unsigned char *)&scan->a0) != 0) {
             VLOG_WARN("module serial ID data failed checksum: %s", port->instance);
             // mark port as present
             port->present = true;
@@ -345,13 +581,19 @@ retry_read:
         */
 
         // parse the data into important fields, and set it as pending data
-        rc = pm_parse(&a0, port);
+        rc = pm_parse(&scan->a0, port);
 
         if (rc == 0) {
             // mark port as present
             port->present = true;
             port->retry = false;
-            set_a2_read_request(port, &a0);
+            port->reset_retries = PM_RESET_RETRIES;
+            port->a2_read_requested = false;
+            set_a2_read_request(port, &scan->a0);
+
+            // a (possibly) new module, get its thresholds right away
+            port->dom_thresholds_valid = false;
+            pm_sched_trigger(port, PM_TASK_THRESHOLDS);
         } else {
             port->retry = true;
             // note: in failure case, pm_parse will already have logged
@@ -360,47 +602,18 @@ retry_read:
         }
     }
 
-    if (port->a2_read_requested == false || true) {
-        return 0;
-    }
-
-retry_read_a2:
-    rc = pm_read_a2(port, (unsigned char *)&a2);
-
-    if (rc != 0) {
-        if (retry_count != 0) {
-            VLOG_DBG("module a2 read failed, retrying: %s", port->instance);
-            retry_count--;
-            goto retry_read_a2;
-        }
-
-        VLOG_WARN("module a2 read failed: %s", port->instance);
-
-        memset(&a2, 0xff, sizeof(a2));
+    if (scan->thresholds_read && 0 == scan->thresholds_rc) {
+        memcpy(&port->cold->dom_thresholds, &scan->thresholds,
+               sizeof(port->cold->dom_thresholds));
+        port->dom_thresholds_valid = true;
+        pm_set_a2_thresholds(port, &port->cold->dom_thresholds);
     }
 
-    pm_set_a2(port, &a2);
-
-    port->a2_read_requested = false;
-
-    return 0;
-}
-
-//
-// pm_read_port_state: read the port state for a port
-//
-// input: port structure
-//
-// output: success only
-//
-int
-pm_read_port_state(pm_port_t *port)
-{
-    if (NULL == port) {
+    if (false == scan->a2_read) {
         return 0;
     }
 
-    pm_read_module_state(port);
+    pm_set_a2(port, &scan->a2);
 
     return 0;
 }
@@ -415,17 +628,7 @@ pm_read_port_state(pm_port_t *port)
 int
 pm_read_state(void)
 {
-    struct shash_node *node;
-
-    SHASH_FOR_EACH(node, &ovs_intfs) {
-        pm_port_t *port;
-
-        port = (pm_port_t *)node->data;
-
-        pm_read_port_state(port);
-    }
-
-    return 0;
+    return pm_scan_run();
 }
 
 //
@@ -458,11 +661,9 @@ pm_configure_qsfp(pm_port_t *port)
         }
     }
 
-    port->port_enable = data;
+    port->cold->port_enable = data;
     return;
 #else
-    const YamlDevice    *device;
-
     int                 rc;
 
     if (false == port->present) {
@@ -490,10 +691,8 @@ pm_configure_qsfp(pm_port_t *port)
         }
     }
 
-    device = yaml_find_device(global_yaml_handle, port->subsystem, port->module_device->module_eeprom);
-
-    rc = i2c_data_write(global_yaml_handle, device, port->subsystem,
-                        QSFP_DISABLE_OFFSET, sizeof(data), &data);
+    rc = i2c_data_write(global_yaml_handle, port->cold->access.a0_device,
+                        port->cold->subsystem, QSFP_DISABLE_OFFSET, sizeof(data), &data);
 
     if (0 != rc) {
         VLOG_WARN("Failed to write QSFP enable/disable: %s (%d)",
@@ -520,23 +719,17 @@ pm_configure_qsfp(pm_port_t *port)
 static void
 pm_reset(pm_port_t *port, clear_reset_t clear)
 {
-    i2c_bit_op *        reg_op = NULL;
+    const i2c_bit_op *  reg_op = port->cold->access.reset_op;
     uint32_t            data;
     int                 rc;
 
-    if (0 == strcmp(port->module_device->connector, CONNECTOR_QSFP_PLUS)) {
-        reg_op = port->module_device->module_signals.qsfp.qsfpp_reset;
-    } else if (0 == strcmp(port->module_device->connector, CONNECTOR_QSFP28)) {
-        reg_op = port->module_device->module_signals.qsfp28.qsfp28p_reset;
-    }
-
     if (NULL == reg_op) {
         VLOG_DBG("port %s does does not have a reset", port->instance);
         return;
     }
 
     data = clear ? 0 : 0xffu;
-    rc = i2c_reg_write(global_yaml_handle, port->subsystem, reg_op, data);
+    rc = i2c_reg_write(global_yaml_handle, port->cold->subsystem, reg_op, data);
 
     if (rc != 0) {
         VLOG_WARN("Unable to %s reset for port: %s (%d)",
@@ -552,14 +745,14 @@ pm_reset(pm_port_t *port, clear_reset_t clear)
 //
 // output: none
 //
-#define ONE_MILLISECOND 1000000
-#define TEN_MILLISECONDS (10*ONE_MILLISECOND)
+// The module isn't read until it has settled, PM_RESET_SETTLE_TIME later.
+//
 void
 pm_clear_reset(pm_port_t *port)
 {
-    struct timespec req = {0,TEN_MILLISECONDS};
     pm_reset(port, CLEAR_RESET);
-    nanosleep(&req, NULL);
+    port->reset_state = PM_RESET_SETTLE;
+    pm_sched_at(port, PM_TASK_RESET, time_msec() + PM_RESET_SETTLE_TIME);
 }
 
 
@@ -570,13 +763,43 @@ pm_clear_reset(pm_port_t *port)
 //
 // output: none
 //
+// The reset is held for PM_RESET_HOLD_TIME, then cleared by pm_reset_run.
+//
 static void
 pm_reset_port(pm_port_t *port)
 {
-    struct timespec req = {0,ONE_MILLISECOND};
     pm_reset(port, SET_RESET);
-    nanosleep(&req, NULL);
-    pm_clear_reset(port);
+    port->reset_state = PM_RESET_HOLD;
+    pm_sched_at(port, PM_TASK_RESET, time_msec() + PM_RESET_HOLD_TIME);
+}
+
+//
+// pm_reset_run: move a module reset on to its next step, when its timer
+//               has expired
+//
+// input: port structure
+//
+// output: none
+//
+void
+pm_reset_run(pm_port_t *port)
+{
+    switch (port->reset_state) {
+    case PM_RESET_HOLD:
+        pm_clear_reset(port);
+        break;
+
+    case PM_RESET_SETTLE:
+        // the module is ready, identify it right away
+        port->reset_state = PM_RESET_READY;
+        pm_sched_trigger(port, PM_TASK_PRESENCE);
+        pm_sched_trigger(port, PM_TASK_IDENTITY);
+        break;
+
+    case PM_RESET_READY:
+    default:
+        break;
+    }
 }
 
 //
@@ -592,16 +815,16 @@ pm_configure_port(pm_port_t *port)
 #ifdef PLATFORM_SIMULATION
     bool                enabled;
 
-    if ((0 == strcmp(port->module_device->connector, CONNECTOR_QSFP_PLUS)) ||
-        (0 == strcmp(port->module_device->connector, CONNECTOR_QSFP28))) {
+    if (MODULE_TYPE_QSFP_PLUS == port->cold->access.module_type ||
+        MODULE_TYPE_QSFP28 == port->cold->access.module_type) {
         pm_configure_qsfp(port);
     } else {
         enabled = port->hw_enable;
 
         if (enabled) {
-            port->port_enable = 1;
+            port->cold->port_enable = 1;
         } else {
-            port->port_enable = 0;
+            port->cold->port_enable = 0;
         }
     }
 
@@ -609,25 +832,29 @@ pm_configure_port(pm_port_t *port)
 #else
     int                 rc;
     uint32_t            data;
-    i2c_bit_op          *reg_op;
+    const i2c_bit_op    *reg_op;
     bool                enabled;
 
     if (NULL == port) {
         return;
     }
 
-    if ((0 == strcmp(port->module_device->connector, CONNECTOR_QSFP_PLUS)) ||
-        (0 == strcmp(port->module_device->connector, CONNECTOR_QSFP28))) {
+    if (MODULE_TYPE_QSFP_PLUS == port->cold->access.module_type ||
+        MODULE_TYPE_QSFP28 == port->cold->access.module_type) {
         pm_configure_qsfp(port);
         return;
     }
 
-    reg_op = port->module_device->module_signals.sfp.sfpp_tx_disable;
+    reg_op = port->cold->access.tx_disable_op;
+    if (NULL == reg_op) {
+        VLOG_DBG("port %s does not have a tx disable", port->instance);
+        return;
+    }
 
     enabled = port->hw_enable;
     data = enabled ? 0: reg_op->bit_mask;
 
-    rc = i2c_reg_write(global_yaml_handle, port->subsystem, reg_op, data);
+    rc = i2c_reg_write(global_yaml_handle, port->cold->subsystem, reg_op, data);
 
     if (rc != 0) {
         VLOG_WARN("Unable to set module disable for port: %s (%d)",
@@ -642,23 +869,22 @@ pm_configure_port(pm_port_t *port)
 
 #ifdef PLATFORM_SIMULATION
 int
-pmd_sim_insert(const char *name, const char *file, struct ds *ds)
+pmd_sim_insert(const char *name, const char *file, bool notify,
+               struct ds *ds)
 {
-    struct shash_node *node;
     pm_port_t *port;
     FILE *fp;
     unsigned char *data;
 
-    node = shash_find(&ovs_intfs, name);
-    if (NULL == node) {
+    port = pm_port_find(name);
+    if (NULL == port) {
         ds_put_cstr(ds, "No such interface");
         return -1;
     }
-    port = (pm_port_t *)node->data;
 
-    if (NULL != port->module_data) {
-        free((void *)port->module_data);
-        port->module_data = NULL;
+    if (NULL != port->cold->module_data) {
+        free((void *)port->cold->module_data);
+        port->cold->module_data = NULL;
     }
 
     fp = fopen(file, "r");
@@ -679,33 +905,101 @@ pmd_sim_insert(const char *name, const char *file, struct ds *ds)
 
     fclose(fp);
 
-    port->module_data = data;
+    port->cold->module_data = data;
+
+    // without an event, the change is found by the presence sweep
+    if (notify) {
+        pm_event_notify(port->instance);
+    }
 
     ds_put_cstr(ds, "Pluggable module inserted");
 
     return 0;
 }
 
+//
+// pmd_sim_dom: feed DOM data to a port as if it had been read from the
+//              module
+//
+// The file has the A2 page (or QSFP lower page) data. SFP thresholds are
+// taken from the same data. The reply tells if the data was published.
+//
 int
-pmd_sim_remove(const char *name, struct ds *ds)
+pmd_sim_dom(const char *name, const char *file, struct ds *ds)
 {
-    struct shash_node *node;
     pm_port_t *port;
+    FILE *fp;
+    pm_sfp_dom_t a2;
+    pm_dom_store_t published;
 
-    node = shash_find(&ovs_intfs, name);
-    if (NULL == node) {
+    port = pm_port_find(name);
+    if (NULL == port) {
         ds_put_cstr(ds, "No such interface");
         return -1;
     }
-    port = (pm_port_t *)node->data;
 
-    if (NULL == port->module_data) {
+    if (NULL == port->cold->module_data) {
         ds_put_cstr(ds, "Pluggable module not present");
         return -1;
     }
 
-    free((void *)port->module_data);
-    port->module_data = NULL;
+    fp = fopen(file, "r");
+
+    if (NULL == fp) {
+        ds_put_cstr(ds, "Can't open file");
+        return -1;
+    }
+
+    if (1 != fread(&a2, sizeof(a2), 1, fp)) {
+        ds_put_cstr(ds, "Unable to read data");
+        fclose(fp);
+        return -1;
+    }
+
+    fclose(fp);
+
+    memcpy(&published, &port->cold->dom, sizeof(published));
+
+    if (MODULE_TYPE_SFP_PLUS == port->cold->access.module_type) {
+        memcpy(port->cold->dom_thresholds.sfp, &a2,
+               sizeof(port->cold->dom_thresholds.sfp));
+        port->dom_thresholds_valid = true;
+        pm_set_a2_thresholds(port, &port->cold->dom_thresholds);
+    }
+
+    pm_set_a2(port, &a2);
+
+    if (0 != memcmp(&published, &port->cold->dom, sizeof(published))) {
+        ds_put_cstr(ds, "DOM data published");
+    } else {
+        ds_put_cstr(ds, "DOM data unchanged");
+    }
+
+    return 0;
+}
+
+int
+pmd_sim_remove(const char *name, bool notify, struct ds *ds)
+{
+    pm_port_t *port;
+
+    port = pm_port_find(name);
+    if (NULL == port) {
+        ds_put_cstr(ds, "No such interface");
+        return -1;
+    }
+
+    if (NULL == port->cold->module_data) {
+        ds_put_cstr(ds, "Pluggable module not present");
+        return -1;
+    }
+
+    free((void *)port->cold->module_data);
+    port->cold->module_data = NULL;
+
+    if (notify) {
+        pm_event_notify(port->instance);
+    }
 
     ds_put_cstr(ds, "Pluggable module removed");
     return 0;
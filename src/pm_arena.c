@@ -0,0 +1,197 @@
+/*
+ *  (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License. You may obtain
+ *  a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *  License for the specific language governing permissions and limitations
+ *  under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-pmd
+ *
+ * @file
+ * Source file for the per-port string arena.
+ *
+ * The ovs_module_info strings of a port are bump allocated from one buffer
+ * owned by the port. Replaced strings aren't freed; all of them are released
+ * at once by pm_arena_reset when the module data is deleted (module removed
+ * or unrecognized). If the buffer fills up, the live strings are copied to a
+ * new buffer, so the arena only grows to about twice the port's live data.
+ * A port whose module doesn't change doesn't touch the heap at all.
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pmd.h"
+
+VLOG_DEFINE_THIS_MODULE(pm_arena);
+
+// enough for the strings of a typical module (including a0 and a2)
+#define PM_ARENA_MIN_SIZE   1024
+
+// the ovs_module_info fields that can hold arena strings (the vendor and
+// speed fields are interned)
+static const size_t pm_arena_fields[] = {
+    offsetof(struct ovs_module_info, cable_length),
+    offsetof(struct ovs_module_info, cable_technology),
+    offsetof(struct ovs_module_info, connector),
+    offsetof(struct ovs_module_info, connector_status),
+    offsetof(struct ovs_module_info, power_mode),
+    offsetof(struct ovs_module_info, vendor_serial_number),
+    offsetof(struct ovs_module_info, a0),
+    offsetof(struct ovs_module_info, a0_uppers),
+    offsetof(struct ovs_module_info, a2),
+};
+
+#define PM_ARENA_N_FIELDS   (sizeof(pm_arena_fields) / sizeof(pm_arena_fields[0]))
+
+static char **
+pm_arena_field(pm_port_t *port, size_t idx)
+{
+    return (char **)((char *)&port->cold->ovs_module_columns + pm_arena_fields[idx]);
+}
+
+//
+// pm_arena_owns: check if a string is in the arena (static strings, like
+//                the connector enums, aren't)
+//
+static bool
+pm_arena_owns(const pm_arena_t *arena, const char *str)
+{
+    return (NULL != str && NULL != arena->base &&
+            str >= arena->base && str < arena->base + arena->used);
+}
+
+//
+// pm_arena_compact: move the live strings of a port to a new buffer, with
+//                   room for at least len more bytes
+//
+static void
+pm_arena_compact(pm_port_t *port, size_t len)
+{
+    pm_arena_t *arena = &port->cold->arena;
+    pm_arena_t new_arena;
+    size_t live = 0;
+    size_t idx;
+
+    for (idx = 0; idx < PM_ARENA_N_FIELDS; idx++) {
+        char *str = *pm_arena_field(port, idx);
+
+        if (pm_arena_owns(arena, str)) {
+            live += strlen(str) + 1;
+        }
+    }
+
+    new_arena.size = 2 * (live + len);
+    if (new_arena.size < PM_ARENA_MIN_SIZE) {
+        new_arena.size = PM_ARENA_MIN_SIZE;
+    }
+    new_arena.base = xmalloc(new_arena.size);
+    new_arena.used = 0;
+
+    for (idx = 0; idx < PM_ARENA_N_FIELDS; idx++) {
+        char **field = pm_arena_field(port, idx);
+        size_t str_len;
+
+        if (!pm_arena_owns(arena, *field)) {
+            continue;
+        }
+
+        str_len = strlen(*field) + 1;
+        memcpy(new_arena.base + new_arena.used, *field, str_len);
+        *field = new_arena.base + new_arena.used;
+        new_arena.used += str_len;
+    }
+
+    VLOG_DBG("%s: string arena compacted, %zu of %zu bytes in use",
+             port->instance, new_arena.used, new_arena.size);
+
+    free(arena->base);
+    *arena = new_arena;
+}
+
+//
+// pm_arena_alloc: allocate memory for a port string
+//
+// input: port structure, length in bytes
+//
+// output: memory, valid until the next pm_arena_reset
+//
+void *
+pm_arena_alloc(pm_port_t *port, size_t len)
+{
+    pm_arena_t *arena = &port->cold->arena;
+    void *mem;
+
+    if (arena->size - arena->used < len) {
+        pm_arena_compact(port, len);
+    }
+
+    mem = arena->base + arena->used;
+    arena->used += len;
+
+    return mem;
+}
+
+char *
+pm_arena_strdup(pm_port_t *port, const char *str)
+{
+    size_t len = strlen(str) + 1;
+
+    return memcpy(pm_arena_alloc(port, len), str, len);
+}
+
+char *
+pm_arena_printf(pm_port_t *port, const char *format, ...)
+{
+    va_list args;
+    char *str;
+    int len;
+
+    va_start(args, format);
+    len = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    str = pm_arena_alloc(port, len + 1);
+
+    va_start(args, format);
+    vsnprintf(str, len + 1, format, args);
+    va_end(args);
+
+    return str;
+}
+
+//
+// pm_arena_reset: release all strings of a port
+//
+// note: the caller must have cleared all ovs_module_info fields that point
+//       into the arena. The buffer is kept for the next module.
+//
+void
+pm_arena_reset(pm_port_t *port)
+{
+    port->cold->arena.used = 0;
+}
+
+//
+// pm_arena_destroy: free a port's arena
+//
+void
+pm_arena_destroy(pm_port_t *port)
+{
+    free(port->cold->arena.base);
+    memset(&port->cold->arena, 0, sizeof(port->cold->arena));
+}
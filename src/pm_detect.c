@@ -25,10 +25,12 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
+#include <strings.h>
 #include <stdarg.h>
 #include <ctype.h>
 #include <math.h>
 
+#include <util.h>
 #include <vswitch-idl.h>
 #include <openswitch-idl.h>
 
@@ -42,8 +44,60 @@ VLOG_DEFINE_THIS_MODULE(pm_detect);
 // some fields are padded with spaces - need to strip trailing spaces
 #define SPACE   0x20
 
-static char ascii_map[] = {'0', '1', '2', '3', '4', '5', '6', '7',
-                           '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+#define HEX_PAIR_ROW(hi) \
+    {hi, '0'}, {hi, '1'}, {hi, '2'}, {hi, '3'}, {hi, '4'}, {hi, '5'}, \
+    {hi, '6'}, {hi, '7'}, {hi, '8'}, {hi, '9'}, {hi, 'A'}, {hi, 'B'}, \
+    {hi, 'C'}, {hi, 'D'}, {hi, 'E'}, {hi, 'F'}
+
+// two hex characters for each byte value
+static const char hex_pairs[256][2] = {
+    HEX_PAIR_ROW('0'), HEX_PAIR_ROW('1'), HEX_PAIR_ROW('2'), HEX_PAIR_ROW('3'),
+    HEX_PAIR_ROW('4'), HEX_PAIR_ROW('5'), HEX_PAIR_ROW('6'), HEX_PAIR_ROW('7'),
+    HEX_PAIR_ROW('8'), HEX_PAIR_ROW('9'), HEX_PAIR_ROW('A'), HEX_PAIR_ROW('B'),
+    HEX_PAIR_ROW('C'), HEX_PAIR_ROW('D'), HEX_PAIR_ROW('E'), HEX_PAIR_ROW('F'),
+};
+
+// pages set with SET_BINARY must fit in the port's raw page copies
+BUILD_ASSERT_DECL(sizeof(pm_sfp_serial_id_t) <= PM_RAW_PAGE_LEN);
+BUILD_ASSERT_DECL(sizeof(pm_qsfp_serial_id_t) <= PM_RAW_PAGE_LEN);
+BUILD_ASSERT_DECL(sizeof(pm_sfp_dom_t) <= PM_RAW_PAGE_LEN);
+BUILD_ASSERT_DECL(sizeof(pm_qsfp_dom_t) <= PM_RAW_PAGE_LEN);
+
+//
+// hex_to_ascii_buf: Converts binary data in input buffer to ascii format,
+//                   with a space between 4 byte words.
+//                   ascii must have room for HEX_ASCII_LEN(buf_size) bytes.
+//
+void
+hex_to_ascii_buf(const unsigned char *buf, size_t buf_size, char *ascii)
+{
+    const size_t word_size = 4;
+    char *out = ascii;
+    size_t i;
+
+    // whole words
+    for (i = 0; i + word_size <= buf_size; i += word_size) {
+        if (i > 0) {
+            *out++ = SPACE;
+        }
+        memcpy(out, hex_pairs[buf[i]], 2);
+        memcpy(out + 2, hex_pairs[buf[i + 1]], 2);
+        memcpy(out + 4, hex_pairs[buf[i + 2]], 2);
+        memcpy(out + 6, hex_pairs[buf[i + 3]], 2);
+        out += 2 * word_size;
+    }
+
+    // partial last word
+    if (i > 0 && i < buf_size) {
+        *out++ = SPACE;
+    }
+    for (; i < buf_size; i++) {
+        memcpy(out, hex_pairs[buf[i]], 2);
+        out += 2;
+    }
+
+    *out = 0;
+}
 
 //
 // hex_to_ascii: Converts binary data in input buffer to ascii format.
@@ -52,26 +106,14 @@ static char ascii_map[] = {'0', '1', '2', '3', '4', '5', '6', '7',
 char *
 hex_to_ascii(char *buf, int buf_size)
 {
-    int i = 0;
-    int j = 0;
-    const int word_size = 4;
     char *ascii;
 
-    // Allocate sufficient space for ascii conversion, word separation
-    // characters and NUL termination.
-    ascii = malloc((2 * buf_size) + (buf_size / word_size) + 1);
+    ascii = malloc(HEX_ASCII_LEN(buf_size));
     if (NULL == ascii) {
         return NULL;
     }
 
-    for (i=0; i<buf_size; ++i) {
-        if ( (i > 0 ) && (0 ==  i % word_size)) {
-            ascii[j++] = SPACE;
-        }
-        ascii[j++] = ascii_map[(buf[i] & 0xf0) >> 4];
-        ascii[j++] = ascii_map[buf[i] & 0xf];
-    }
-    ascii[j] = 0;
+    hex_to_ascii_buf((const unsigned char *)buf, buf_size, ascii);
     return ascii;
 }
 
@@ -81,29 +123,22 @@ set_supported_speeds(pm_port_t *port, size_t count, ...)
     va_list args;
     size_t idx;
     int speed;
-    char *speeds = NULL;
-    char *new_speeds = NULL;
+    char speeds[128];
+    size_t len = 0;
 
     va_start(args, count);
-    if (NULL != port->ovs_module_columns.supported_speeds) {
-        free(port->ovs_module_columns.supported_speeds);
-    }
 
-    for (idx = 0; idx < count; idx++) {
+    speeds[0] = '\0';
+    for (idx = 0; idx < count && len < sizeof(speeds); idx++) {
         speed = va_arg(args, int);
-        asprintf(&new_speeds, "%s%s%d",
-                 (NULL == speeds) ? "" :  speeds,
-                 (0 == idx) ? "" :  " ",
-                 speed);
-        if (speeds != NULL) {
-            free(speeds);
-        }
-        speeds = new_speeds;
+        len += snprintf(speeds + len, sizeof(speeds) - len, "%s%d",
+                        (0 == idx) ? "" :  " ",
+                        speed);
     }
 
     va_end(args);
-    port->ovs_module_columns.supported_speeds = speeds;
-    port->module_info_changed = 1;
+
+    SET_INTERN(port, supported_speeds, speeds);
 }
 
 //
@@ -120,6 +155,123 @@ pm_oui_format(char *ascii_oui, unsigned char *binary_oui)
         binary_oui[2]);
 }
 
+// Module classification: what a module's compliance codes say it is
+typedef struct {
+    char        *connector;         /* NULL for unrecognized modules */
+    bool        optical;
+    bool        cable;              /* cable_technology/length are set */
+    int         speed;              /* Mb/s, max and only supported speed */
+} pm_module_class_t;
+
+#define PM_CLASS(connector, optical, speed) \
+    { OVSREC_INTERFACE_PM_INFO_CONNECTOR_##connector, (optical), false, (speed) }
+
+static const pm_module_class_t pm_class_unrecognized = { NULL, false, false, 0 };
+
+// SFP modules, selected by their transceiver compliance codes
+enum pm_sfp_class {
+    PM_SFP_1000BASE_SX,
+    PM_SFP_1000BASE_LX,
+    PM_SFP_1000BASE_CX,
+    PM_SFP_1000BASE_T,
+    PM_SFP_10GBASE_SR,
+    PM_SFP_10GBASE_LR,
+    PM_SFP_10GBASE_LRM,
+    PM_SFP_CLASS_MAX
+};
+
+static const pm_module_class_t pm_sfp_classes[PM_SFP_CLASS_MAX] = {
+    [PM_SFP_1000BASE_SX]    = PM_CLASS(SFP_SX,   true,  1000),
+    [PM_SFP_1000BASE_LX]    = PM_CLASS(SFP_LX,   true,  1000),
+    [PM_SFP_1000BASE_CX]    = PM_CLASS(SFP_CX,   false, 1000),
+    [PM_SFP_1000BASE_T]     = PM_CLASS(SFP_RJ45, false, 1000),
+    [PM_SFP_10GBASE_SR]     = PM_CLASS(SFP_SR,   true,  10000),
+    [PM_SFP_10GBASE_LR]     = PM_CLASS(SFP_LR,   true,  10000),
+    [PM_SFP_10GBASE_LRM]    = PM_CLASS(SFP_LRM,  true,  10000),
+};
+
+// QSFP modules, by the bit of their ethernet compliance code (byte 131).
+// The lowest recognized bit wins.
+static const pm_module_class_t pm_qsfp_classes[8] = {
+    [1]     = PM_CLASS(QSFP_LR4,  true,  40000),  /* enet_40gbase_lr4 */
+    [2]     = PM_CLASS(QSFP_SR4,  true,  40000),  /* enet_40gbase_sr4 */
+    [3]     = PM_CLASS(QSFP_CR4,  false, 40000),  /* enet_40gbase_cr4 */
+};
+
+#define PM_QSFP_CLASS_BITS  ((1 << 1) | (1 << 2) | (1 << 3))
+
+// QSFP28 modules with the enet_extended bit set, by their extended
+// compliance code (byte 192)
+static const pm_module_class_t pm_qsfp28_ext_classes[256] = {
+    [PM_QSFP_EXT_COMPLIANCE_CODE_100GBASE_SR4]   = PM_CLASS(QSFP28_SR4,   true,  100000),
+    [PM_QSFP_EXT_COMPLIANCE_CODE_100GBASE_LR4]   = PM_CLASS(QSFP28_LR4,   true,  100000),
+    [PM_QSFP_EXT_COMPLIANCE_CODE_100GBASE_CWDM4] = PM_CLASS(QSFP28_CWDM4, true,  100000),
+    [PM_QSFP_EXT_COMPLIANCE_CODE_100GBASE_PSM4]  = PM_CLASS(QSFP28_PSM4,  true,  100000),
+    [PM_QSFP_EXT_COMPLIANCE_CODE_100GBASE_CR4]   = PM_CLASS(QSFP28_CR4,   false, 100000),
+    [PM_QSFP_EXT_COMPLIANCE_CODE_100GBASE_CLR4]  = PM_CLASS(QSFP28_CLR4,  true,  100000),
+};
+
+//
+// pm_qsfp_classify: look up the class of a QSFP+ or QSFP28 module
+//
+// input: serial id data, true for QSFP28 ports (extended compliance codes)
+//
+// output: module class
+//
+static const pm_module_class_t *
+pm_qsfp_classify(const pm_qsfp_serial_id_t *serial_id, bool extended)
+{
+    unsigned int compliance;
+
+    if (extended && 0 != serial_id->spec_compliance.enet_extended) {
+        return &pm_qsfp28_ext_classes[serial_id->options.ext_compliance_code];
+    }
+
+    compliance = *(const unsigned char *)&serial_id->spec_compliance &
+                 PM_QSFP_CLASS_BITS;
+    if (0 == compliance) {
+        return &pm_class_unrecognized;
+    }
+
+    return &pm_qsfp_classes[ffs(compliance) - 1];
+}
+
+//
+// pm_set_module_class: set the connector, speed and cable data of a module
+//
+// input: port structure, module class
+//
+// output: none
+//
+static void
+pm_set_module_class(pm_port_t *port, const pm_module_class_t *module_class)
+{
+    char max_speed[16];
+
+    port->optical = module_class->optical;
+
+    if (NULL == module_class->connector) {
+        VLOG_DBG("module is unrecognized: %s", port->instance);
+        SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_UNKNOWN);
+        SET_STATIC_STRING(port, connector_status,
+                          OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_UNRECOGNIZED);
+    } else {
+        VLOG_DBG("module is %s: %s", module_class->connector, port->instance);
+        SET_STATIC_STRING(port, connector, module_class->connector);
+        SET_STATIC_STRING(port, connector_status,
+                          OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
+    }
+
+    snprintf(max_speed, sizeof(max_speed), "%d", module_class->speed);
+    SET_INTERN(port, max_speed, max_speed);
+    set_supported_speeds(port, 1, module_class->speed);
+
+    if (!module_class->cable) {
+        DELETE(port, cable_technology);
+        DELETE_FREE(port, cable_length);
+    }
+}
+
 //
 // pm_parse: get important data out of serial id data
 //
@@ -136,32 +288,28 @@ pm_parse(
     char                    vendor_oui[PM_VENDOR_OUI_LEN*3];
     size_t                  idx;
     pm_qsfp_serial_id_t*    qsfpp_serial_id;
+    const pm_module_class_t *module_class;
 
 VLOG_WARN("w %s(%d): port=%s, pluggable=%d, connector=%s", __FUNCTION__, __LINE__, port->instance, 
-    port->module_device->pluggable, port->module_device->connector);
+    port->cold->module_device->pluggable, port->cold->module_device->connector);
 
     // ignore modules that aren't pluggable
-    if (false == port->module_device->pluggable) {
+    if (false == port->cold->module_device->pluggable) {
         VLOG_DBG("port is not pluggable: %s", port->instance);
         return 0;
     }
 
     // ignore modules that don't have connector data
-    if (NULL == port->module_device->connector) {
+    if (NULL == port->cold->module_device->connector) {
         VLOG_WARN("no connector info for port: %s", port->instance);
         return -1;
     }
 
     // prepare for handling SFP+, QSFP+ and QSFP28 differently
-    if (strcmp(port->module_device->connector, CONNECTOR_SFP_PLUS) == 0) {
-        type = MODULE_TYPE_SFP_PLUS;
-    } else if (strcmp(port->module_device->connector, CONNECTOR_QSFP_PLUS) == 0) {
-        type = MODULE_TYPE_QSFP_PLUS;
-    } else if (strcmp(port->module_device->connector, CONNECTOR_QSFP28) == 0) {
-        type = MODULE_TYPE_QSFP28;
-    } else {
+    type = port->cold->access.module_type;
+    if (MODULE_TYPE_UNKNOWN == type) {
         VLOG_WARN("unknown connector type for port: %s (%s)",
-                  port->instance, port->module_device->connector);
+                  port->instance, port->cold->module_device->connector);
         pm_delete_all_data(port);
         SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_UNKNOWN);
         return -1;
@@ -177,23 +325,16 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
             VLOG_WARN("port is SFP plus pluggable: %s", port->instance);
             // Supported SFP module types
             if (PM_CONNECTOR_COPPER_PIGTAIL == serial_datap->connector && false) {
-                unsigned int speed = 0;
                 char *cable_tech = OVSREC_INTERFACE_PM_INFO_CABLE_TECHNOLOGY_PASSIVE;
-                port->optical = false;
+                pm_module_class_t dac = PM_CLASS(SFP_DAC, false, 1000);
 
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_SFP_DAC);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
                 VLOG_WARN("bit rate for %s is 0x%x",
                          port->instance, serial_datap->bit_rate_nominal);
                 if (serial_datap->bit_rate_nominal >= SFP_BIT_RATE_NOMINAL_10G) {
-                    speed = 10000;
-                } else {
-                    speed = 1000;
+                    dac.speed = 10000;
                 }
-                VLOG_WARN("module is DAC at %d: %s", speed, port->instance);
-                SET_INT_STRING(port, max_speed, speed);
-                set_supported_speeds(port, 1, speed);
+                dac.cable = true;
+                pm_set_module_class(port, &dac);
                 // determine active/passive
                 if (0 != serial_datap->transceiver.cable_technology_active) {
                     cable_tech = OVSREC_INTERFACE_PM_INFO_CABLE_TECHNOLOGY_ACTIVE;
@@ -202,92 +343,29 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
                 }
                 SET_STATIC_STRING(port, cable_technology, cable_tech);
                 SET_INT_STRING(port, cable_length, serial_datap->length_copper);
+                module_class = NULL;
             } else if (0 != serial_datap->transceiver.enet_1000base_sx && false) {
-                VLOG_WARN("module is 1G_SX: %s", port->instance);
-                // handle sx type
-                port->optical = true;
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_SFP_SX);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                SET_INT_STRING(port, max_speed, 1000);
-                set_supported_speeds(port, 1, 1000);
-                DELETE(port, cable_technology);
-                DELETE_FREE(port, cable_length);
+                module_class = &pm_sfp_classes[PM_SFP_1000BASE_SX];
             } else if (0 != serial_datap->transceiver.enet_1000base_lx && false) {
-                // handle lx type
-                VLOG_WARN("module is 1G_LX: %s", port->instance);
-                port->optical = true;
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_SFP_LX);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                SET_INT_STRING(port, max_speed, 1000);
-                set_supported_speeds(port, 1, 1000);
-                DELETE(port, cable_technology);
-                DELETE_FREE(port, cable_length);
+                module_class = &pm_sfp_classes[PM_SFP_1000BASE_LX];
             } else if (0 != serial_datap->transceiver.enet_1000base_cx && false) {
-                // handle cx type
-                port->optical = false;
-                VLOG_WARN("module is 1G_CX: %s", port->instance);
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_SFP_CX);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                SET_INT_STRING(port, max_speed, 1000);
-                set_supported_speeds(port, 1, 1000);
-                DELETE(port, cable_technology);
-                DELETE_FREE(port, cable_length);
+                module_class = &pm_sfp_classes[PM_SFP_1000BASE_CX];
             } else if (0 != serial_datap->transceiver.enet_1000base_t && false) {
-                // handle RJ45 type
-                port->optical = false;
-                VLOG_WARN("module is 1G RJ45: %s", port->instance);
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_SFP_RJ45);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                SET_INT_STRING(port, max_speed, 1000);
-                set_supported_speeds(port, 1, 1000);
-                DELETE(port, cable_technology);
-                DELETE_FREE(port, cable_length);
+                module_class = &pm_sfp_classes[PM_SFP_1000BASE_T];
             } else if (0 != serial_datap->transceiver.enet_10gbase_sr || true) {
-                // handle sr type
-                VLOG_WARN("module is 10G SR: %s", port->instance);
-                port->optical = true;
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_SFP_SR);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                SET_INT_STRING(port, max_speed, 10000);
-                set_supported_speeds(port, 1, 10000);
-                DELETE(port, cable_technology);
-                DELETE_FREE(port, cable_length);
+                module_class = &pm_sfp_classes[PM_SFP_10GBASE_SR];
             } else if (0 != serial_datap->transceiver.enet_10gbase_lr) {
-                VLOG_WARN("module is 10G LR: %s", port->instance);
-                port->optical = true;
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_SFP_LR);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                SET_INT_STRING(port, max_speed, 10000);
-                set_supported_speeds(port, 1, 10000);
-                DELETE(port, cable_technology);
-                DELETE_FREE(port, cable_length);
+                module_class = &pm_sfp_classes[PM_SFP_10GBASE_LR];
             } else if (0 != serial_datap->transceiver.enet_10gbase_lrm) {
-                VLOG_WARN("module is 10G LRM: %s", port->instance);
-                port->optical = true;
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_SFP_LRM);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                SET_INT_STRING(port, max_speed, 10000);
-                set_supported_speeds(port, 1, 10000);
-                DELETE(port, cable_technology);
-                DELETE_FREE(port, cable_length);
+                module_class = &pm_sfp_classes[PM_SFP_10GBASE_LRM];
             } else {
-                VLOG_WARN("module is unrecognized: %s", port->instance);
-                port->optical = false;
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_UNKNOWN);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_UNRECOGNIZED);
-                SET_INT_STRING(port, max_speed, 0);
-                set_supported_speeds(port, 1, 0);
-                DELETE(port, cable_technology);
-                DELETE_FREE(port, cable_length);
+                module_class = &pm_class_unrecognized;
             }
+
+            if (NULL != module_class) {
+                pm_set_module_class(port, module_class);
+            }
+
             // fill in the rest of the data
             DELETE(port, power_mode);
 
@@ -301,13 +379,13 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
                 idx--;
             }
 
-            SET_STRING(port, vendor_name, vendor_name);
+            SET_INTERN(port, vendor_name, vendor_name);
 
 /*
             // vendor_oui
             pm_oui_format(vendor_oui, serial_datap->vendor_oui);
 
-            SET_STRING(port, vendor_oui, vendor_oui);
+            SET_INTERN(port, vendor_oui, vendor_oui);
 */
             // vendor_part_number
             memcpy(vendor_part_number, "vendor_part_number", PM_VENDOR_PN_LEN);
@@ -319,7 +397,7 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
                 idx--;
             }
 
-            SET_STRING(port, vendor_part_number, vendor_part_number);
+            SET_INTERN(port, vendor_part_number, vendor_part_number);
 
             // vendor_revision
             memcpy(vendor_revision, "rev", PM_SFP_VENDOR_REV_LEN);
@@ -331,7 +409,7 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
                 idx--;
             }
 
-            SET_STRING(port, vendor_revision, vendor_revision);
+            SET_INTERN(port, vendor_revision, vendor_revision);
 
             // vendor_serial_number
             memcpy(vendor_serial_number, "serial_number", PM_VENDOR_SN_LEN);
@@ -356,50 +434,8 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
 
             qsfpp_serial_id = (pm_qsfp_serial_id_t *)serial_datap;
 
-            if (0 != qsfpp_serial_id->spec_compliance.enet_40gbase_lr4) {
-                VLOG_DBG("module is 40G_LR4: %s", port->instance);
-                // handle LR4 type
-                port->optical = true;
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_QSFP_LR4);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                SET_INT_STRING(port, max_speed, 40000);
-                set_supported_speeds(port, 1, 40000);
-                DELETE(port, cable_technology);
-                DELETE_FREE(port, cable_length);
-            } else if (0 != qsfpp_serial_id->spec_compliance.enet_40gbase_sr4) {
-                VLOG_DBG("module is 40G_SR4: %s", port->instance);
-                // handle SR4 type
-                port->optical = true;
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_QSFP_SR4);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                SET_INT_STRING(port, max_speed, 40000);
-                set_supported_speeds(port, 1, 40000);
-                DELETE(port, cable_technology);
-                DELETE_FREE(port, cable_length);
-            } else if (0 != qsfpp_serial_id->spec_compliance.enet_40gbase_cr4) {
-                VLOG_DBG("module is 40G_CR4: %s", port->instance);
-                // handle CR4 type
-                port->optical = false;
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_QSFP_CR4);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                SET_INT_STRING(port, max_speed, 40000);
-                set_supported_speeds(port, 1, 40000);
-                DELETE(port, cable_technology);
-                DELETE_FREE(port, cable_length);
-            } else {
-                VLOG_DBG("module is unsupported: %s", port->instance);
-                port->optical = false;
-                SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_UNKNOWN);
-                SET_STATIC_STRING(port, connector_status,
-                                  OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_UNRECOGNIZED);
-                SET_INT_STRING(port, max_speed, 0);
-                set_supported_speeds(port, 1, 0);
-                DELETE(port, cable_technology);
-                DELETE_FREE(port, cable_length);
-            }
+            pm_set_module_class(port, pm_qsfp_classify(qsfpp_serial_id, false));
+
             // fill in the rest of the data
             // OPS_TODO: fill in the power mode
             DELETE(port, power_mode);
@@ -414,12 +450,12 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
                 idx--;
             }
 
-            SET_STRING(port, vendor_name, vendor_name);
+            SET_INTERN(port, vendor_name, vendor_name);
 
             // vendor_oui
             pm_oui_format(vendor_oui, qsfpp_serial_id->vendor_oui);
 
-            SET_STRING(port, vendor_oui, vendor_oui);
+            SET_INTERN(port, vendor_oui, vendor_oui);
 
             // vendor_part_number
             memcpy(vendor_part_number, qsfpp_serial_id->vendor_part_number, PM_VENDOR_PN_LEN);
@@ -431,7 +467,7 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
                 idx--;
             }
 
-            SET_STRING(port, vendor_part_number, vendor_part_number);
+            SET_INTERN(port, vendor_part_number, vendor_part_number);
 
             // vendor_revision
             memcpy(vendor_revision, qsfpp_serial_id->vendor_revision, PM_QSFP_VENDOR_REV_LEN);
@@ -443,7 +479,7 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
                 idx--;
             }
 
-            SET_STRING(port, vendor_revision, vendor_revision);
+            SET_INTERN(port, vendor_revision, vendor_revision);
 
             // vendor_serial_number
             memcpy(vendor_serial_number, qsfpp_serial_id->vendor_serial_number, PM_VENDOR_SN_LEN);
@@ -467,138 +503,8 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
 
             qsfpp_serial_id = (pm_qsfp_serial_id_t *)serial_datap;
 
-            if (0 != qsfpp_serial_id->spec_compliance.enet_extended) {
-                switch (qsfpp_serial_id->options.ext_compliance_code) {
-                    case PM_QSFP_EXT_COMPLIANCE_CODE_100GBASE_SR4:
-                        VLOG_DBG("module is 100G_SR4: %s", port->instance);
-                        // handle SR4 type
-                        port->optical = true;
-                        SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_QSFP28_SR4);
-                        SET_STATIC_STRING(port, connector_status,
-                                          OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                        SET_INT_STRING(port, max_speed, 100000);
-                        set_supported_speeds(port, 1, 100000);
-                        DELETE(port, cable_technology);
-                        DELETE_FREE(port, cable_length);
-                        break;
-                    case PM_QSFP_EXT_COMPLIANCE_CODE_100GBASE_LR4:
-                        VLOG_DBG("module is 100G_LR4: %s", port->instance);
-                        // handle LR4 type
-                        port->optical = true;
-                        SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_QSFP28_LR4);
-                        SET_STATIC_STRING(port, connector_status,
-                                          OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                        SET_INT_STRING(port, max_speed, 100000);
-                        set_supported_speeds(port, 1, 100000);
-                        DELETE(port, cable_technology);
-                        DELETE_FREE(port, cable_length);
-                        break;
-                    case PM_QSFP_EXT_COMPLIANCE_CODE_100GBASE_CWDM4:
-                        VLOG_DBG("module is 100G_CWDM4: %s", port->instance);
-                        // handle CWDM4 type
-                        port->optical = true;
-                        SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_QSFP28_CWDM4);
-                        SET_STATIC_STRING(port, connector_status,
-                                          OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                        SET_INT_STRING(port, max_speed, 100000);
-                        set_supported_speeds(port, 1, 100000);
-                        DELETE(port, cable_technology);
-                        DELETE_FREE(port, cable_length);
-                        break;
-                    case PM_QSFP_EXT_COMPLIANCE_CODE_100GBASE_PSM4:
-                        VLOG_DBG("module is 100G_PSM4: %s", port->instance);
-                        // handle PSM4 type
-                        port->optical = true;
-                        SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_QSFP28_PSM4);
-                        SET_STATIC_STRING(port, connector_status,
-                                          OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                        SET_INT_STRING(port, max_speed, 100000);
-                        set_supported_speeds(port, 1, 100000);
-                        DELETE(port, cable_technology);
-                        DELETE_FREE(port, cable_length);
-                        break;
-                    case PM_QSFP_EXT_COMPLIANCE_CODE_100GBASE_CR4:
-                        VLOG_DBG("module is 100G_CR4: %s", port->instance);
-                        // handle CR4 type
-                        port->optical = false;
-                        SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_QSFP28_CR4);
-                        SET_STATIC_STRING(port, connector_status,
-                                          OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                        SET_INT_STRING(port, max_speed, 100000);
-                        set_supported_speeds(port, 1, 100000);
-                        DELETE(port, cable_technology);
-                        DELETE_FREE(port, cable_length);
-                        break;
-                    case PM_QSFP_EXT_COMPLIANCE_CODE_100GBASE_CLR4:
-                        VLOG_DBG("module is 100G_CLR4: %s", port->instance);
-                        // handle CLR4 type
-                        port->optical = true;
-                        SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_QSFP28_CLR4);
-                        SET_STATIC_STRING(port, connector_status,
-                                          OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                        SET_INT_STRING(port, max_speed, 100000);
-                        set_supported_speeds(port, 1, 100000);
-                        DELETE(port, cable_technology);
-                        DELETE_FREE(port, cable_length);
-                        break;
-                    default:
-                        VLOG_DBG("module is unsupported: %s", port->instance);
-                        port->optical = false;
-                        SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_UNKNOWN);
-                        SET_STATIC_STRING(port, connector_status,
-                                          OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_UNRECOGNIZED);
-                        SET_INT_STRING(port, max_speed, 0);
-                        set_supported_speeds(port, 1, 0);
-                        DELETE(port, cable_technology);
-                        DELETE_FREE(port, cable_length);
-                        break;
-                }
-            } else {
-                if (0 != qsfpp_serial_id->spec_compliance.enet_40gbase_lr4) {
-                    VLOG_DBG("module is 40G_LR4: %s", port->instance);
-                    // handle LR4 type
-                    port->optical = true;
-                    SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_QSFP_LR4);
-                    SET_STATIC_STRING(port, connector_status,
-                                      OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                    SET_INT_STRING(port, max_speed, 40000);
-                    set_supported_speeds(port, 1, 40000);
-                    DELETE(port, cable_technology);
-                    DELETE_FREE(port, cable_length);
-                } else if (0 != qsfpp_serial_id->spec_compliance.enet_40gbase_sr4) {
-                    VLOG_DBG("module is 40G_SR4: %s", port->instance);
-                    // handle SR4 type
-                    port->optical = true;
-                    SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_QSFP_SR4);
-                    SET_STATIC_STRING(port, connector_status,
-                                      OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                    SET_INT_STRING(port, max_speed, 40000);
-                    set_supported_speeds(port, 1, 40000);
-                    DELETE(port, cable_technology);
-                    DELETE_FREE(port, cable_length);
-                } else if (0 != qsfpp_serial_id->spec_compliance.enet_40gbase_cr4) {
-                    VLOG_DBG("module is 40G_CR4: %s", port->instance);
-                    // handle CR4 type
-                    port->optical = false;
-                    SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_QSFP_CR4);
-                    SET_STATIC_STRING(port, connector_status,
-                                      OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_SUPPORTED);
-                    SET_INT_STRING(port, max_speed, 40000);
-                    set_supported_speeds(port, 1, 40000);
-                    DELETE(port, cable_technology);
-                    DELETE_FREE(port, cable_length);
-                } else {
-                    VLOG_DBG("module is unsupported: %s", port->instance);
-                    port->optical = false;
-                    SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_UNKNOWN);
-                    SET_STATIC_STRING(port, connector_status,
-                                      OVSREC_INTERFACE_PM_INFO_CONNECTOR_STATUS_UNRECOGNIZED);
-                    SET_INT_STRING(port, max_speed, 0);
-                    set_supported_speeds(port, 1, 0);
-                    DELETE(port, cable_technology);
-                    DELETE_FREE(port, cable_length);
-                }
-            }
+            pm_set_module_class(port, pm_qsfp_classify(qsfpp_serial_id, true));
+
             // fill in the rest of the data
             // OPS_TODO: fill in the power mode
             DELETE(port, power_mode);
@@ -613,12 +519,12 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
                 idx--;
             }
 
-            SET_STRING(port, vendor_name, vendor_name);
+            SET_INTERN(port, vendor_name, vendor_name);
 
             // vendor_oui
             pm_oui_format(vendor_oui, qsfpp_serial_id->vendor_oui);
 
-            SET_STRING(port, vendor_oui, vendor_oui);
+            SET_INTERN(port, vendor_oui, vendor_oui);
 
             // vendor_part_number
             memcpy(vendor_part_number, qsfpp_serial_id->vendor_part_number, PM_VENDOR_PN_LEN);
@@ -630,7 +536,7 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
                 idx--;
             }
 
-            SET_STRING(port, vendor_part_number, vendor_part_number);
+            SET_INTERN(port, vendor_part_number, vendor_part_number);
 
             // vendor_revision
             memcpy(vendor_revision, qsfpp_serial_id->vendor_revision, PM_QSFP_VENDOR_REV_LEN);
@@ -642,7 +548,7 @@ VLOG_WARN("w %s(%d): port=%s, connector=0x%X, type=%d, 10G=%d", __FUNCTION__, __
                 idx--;
             }
 
-            SET_STRING(port, vendor_revision, vendor_revision);
+            SET_INTERN(port, vendor_revision, vendor_revision);
 
             // vendor_serial_number
             memcpy(vendor_serial_number, qsfpp_serial_id->vendor_serial_number, PM_VENDOR_SN_LEN);
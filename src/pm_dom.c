@@ -23,11 +23,17 @@
 
 #define _GNU_SOURCE
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdarg.h>
 #include <ctype.h>
 #include <math.h>
+#include <stddef.h>
+
+#include <dynamic-string.h>
+#include <smap.h>
+#include <util.h>
 
 #include <vswitch-idl.h>
 #include <openswitch-idl.h>
@@ -44,7 +50,7 @@ VLOG_DEFINE_THIS_MODULE(dom);
 void
 set_a2_read_request(pm_port_t *port, pm_sfp_serial_id_t *serial_datap)
 {
-    if (0 == strcmp(port->module_device->connector, CONNECTOR_SFP_PLUS)) {
+    if (MODULE_TYPE_SFP_PLUS == port->cold->access.module_type) {
         if (serial_datap->diag_monitor_type.implemented_digital &&
                 serial_datap->diag_monitor_type.internally_calibrated &&
                 serial_datap->diag_monitor_type.power_measurement_type &&
@@ -52,10 +58,8 @@ set_a2_read_request(pm_port_t *port, pm_sfp_serial_id_t *serial_datap)
             port->a2_read_requested = true;
             VLOG_DBG("sfpp serial id data indicates that the DOM info is present");
         }
-    } else if ((0 == strcmp(port->module_device->connector,
-                            CONNECTOR_QSFP_PLUS)) ||
-               (0 == strcmp(port->module_device->connector,
-                            CONNECTOR_QSFP28))) {
+    } else if (MODULE_TYPE_QSFP_PLUS == port->cold->access.module_type ||
+               MODULE_TYPE_QSFP28 == port->cold->access.module_type) {
         pm_qsfp_serial_id_t *qsfpp_serial_id;
 
         qsfpp_serial_id = (pm_qsfp_serial_id_t *)serial_datap;
@@ -68,358 +72,704 @@ set_a2_read_request(pm_port_t *port, pm_sfp_serial_id_t *serial_datap)
 }
 
 
+// msb/lsb pair of a DOM value or threshold
+#define PM_DOM_RAW16(msb, lsb)  ((uint16_t)(((msb) << 8) | (lsb)))
+
+// all measures, for the valid masks
+#define PM_DOM_ALL_MEASURES     (PM_DOM_MEASURE_BIT(PM_DOM_MEASURE_MAX) - 1)
+
+// names and units of the DOM measures
+static const struct {
+    const char  *name;              /* key of a module value */
+    const char  *lane_format;       /* key of a lane value, NULL if none */
+    double      scale;              /* units per raw count */
+} pm_dom_measures[PM_DOM_MEASURE_MAX] = {
+    [PM_DOM_TEMPERATURE]    = { "temperature",  NULL,           1.0 / 256 },
+    [PM_DOM_VCC]            = { "vcc",          NULL,           0.0001 },
+    [PM_DOM_TX_BIAS]        = { "tx_bias",      "tx%d_bias",    0.002 },
+    [PM_DOM_RX_POWER]       = { "rx_power",     "rx%d_power",   0.0001 },
+    [PM_DOM_TX_POWER]       = { "tx_power",     "tx%d_power",   0.0001 },
+};
+
+// Publishing deadbands. A value is only published again once it moves more
+// than the larger of the absolute deadband (in the measure's units) and the
+// relative deadband (in percent) away from the value last published, so
+// sensor noise doesn't cause an OVSDB write every poll. Flag and threshold
+// changes are always published.
+static struct {
+    double      absolute;
+    double      relative;
+} pm_dom_deadbands[PM_DOM_MEASURE_MAX] = {
+    [PM_DOM_TEMPERATURE]    = { 0.5,    0 },    /* C */
+    [PM_DOM_VCC]            = { 0.01,   0 },    /* V */
+    [PM_DOM_TX_BIAS]        = { 0.1,    5 },    /* mA */
+    [PM_DOM_RX_POWER]       = { 0.001,  5 },    /* mW */
+    [PM_DOM_TX_POWER]       = { 0.001,  5 },    /* mW */
+};
+
+static const char *pm_dom_levels[PM_DOM_LEVEL_MAX] = {
+    [PM_DOM_HIGH_ALARM]     = "high_alarm",
+    [PM_DOM_LOW_ALARM]      = "low_alarm",
+    [PM_DOM_HIGH_WARNING]   = "high_warning",
+    [PM_DOM_LOW_WARNING]    = "low_warning",
+};
+
+// DOM field descriptors. Each module class describes where its DOM data is
+// in the a2 (SFP) or lower page (QSFP) data and in the threshold data, and
+// pm_dom_decode converts it into a pm_dom_store_t in a single pass. Values
+// and thresholds are 16 bit msb/lsb pairs; signedness and scale are
+// properties of the measure (pm_dom_measures), since the store keeps raw
+// values. Flags are single bits.
+enum pm_dom_field_kind {
+    PM_DOM_FIELD_VALUE,
+    PM_DOM_FIELD_FLAG,
+    PM_DOM_FIELD_THRESHOLD
+};
+
+typedef struct {
+    uint8_t     kind;               /* pm_dom_field_kind */
+    uint8_t     measure;            /* pm_dom_measure */
+    uint8_t     offset;             /* byte (msb) in the page data */
+    uint8_t     lane;               /* values and flags */
+    uint8_t     level;              /* flags and thresholds */
+    uint8_t     bit;                /* flags */
+} pm_dom_field_t;
+
+#define PM_DOM_VALUE(type, msb, measure, lane) \
+    { PM_DOM_FIELD_VALUE, (measure), offsetof(type, msb), (lane), 0, 0 }
+
+#define PM_DOM_FLAG(byte, bit, measure, lane, level) \
+    { PM_DOM_FIELD_FLAG, (measure), (byte), (lane), (level), (bit) }
+
+// the four thresholds of a measure are consecutive, starting with the
+// high alarm
+#define PM_DOM_THRESHOLDS(type, high_alarm_msb, measure) \
+    { PM_DOM_FIELD_THRESHOLD, (measure), offsetof(type, high_alarm_msb), \
+      0, PM_DOM_HIGH_ALARM, 0 }, \
+    { PM_DOM_FIELD_THRESHOLD, (measure), offsetof(type, high_alarm_msb) + 2, \
+      0, PM_DOM_LOW_ALARM, 0 }, \
+    { PM_DOM_FIELD_THRESHOLD, (measure), offsetof(type, high_alarm_msb) + 4, \
+      0, PM_DOM_HIGH_WARNING, 0 }, \
+    { PM_DOM_FIELD_THRESHOLD, (measure), offsetof(type, high_alarm_msb) + 6, \
+      0, PM_DOM_LOW_WARNING, 0 }
+
+// SFP alarm flags are in bytes 112/113, the warning flags in the same bits
+// of bytes 116/117, the low flag is the bit below the high flag
+#define PM_SFP_FLAGS(byte, high_bit, measure) \
+    PM_DOM_FLAG((byte), (high_bit), (measure), 0, PM_DOM_HIGH_ALARM), \
+    PM_DOM_FLAG((byte), (high_bit) - 1, (measure), 0, PM_DOM_LOW_ALARM), \
+    PM_DOM_FLAG((byte) + 4, (high_bit), (measure), 0, PM_DOM_HIGH_WARNING), \
+    PM_DOM_FLAG((byte) + 4, (high_bit) - 1, (measure), 0, PM_DOM_LOW_WARNING)
+
+// QSFP lane flags are nibbles, high alarm in the top bit
+#define PM_QSFP_FLAGS(byte, shift, measure, lane) \
+    PM_DOM_FLAG((byte), (shift) + 3, (measure), (lane), PM_DOM_HIGH_ALARM), \
+    PM_DOM_FLAG((byte), (shift) + 2, (measure), (lane), PM_DOM_LOW_ALARM), \
+    PM_DOM_FLAG((byte), (shift) + 1, (measure), (lane), PM_DOM_HIGH_WARNING), \
+    PM_DOM_FLAG((byte), (shift), (measure), (lane), PM_DOM_LOW_WARNING)
+
+BUILD_ASSERT_DECL(offsetof(pm_sfp_dom_t, alarm_warning_bits) == 112);
+BUILD_ASSERT_DECL(offsetof(pm_qsfp_dom_t, interrupt_flags) == 3);
+
+static const pm_dom_field_t pm_sfp_dom_live[] = {
+    PM_DOM_VALUE(pm_sfp_dom_t, temperature_msb, PM_DOM_TEMPERATURE, 0),
+    PM_DOM_VALUE(pm_sfp_dom_t, vcc_msb, PM_DOM_VCC, 0),
+    PM_DOM_VALUE(pm_sfp_dom_t, tx_bias_msb, PM_DOM_TX_BIAS, 0),
+    PM_DOM_VALUE(pm_sfp_dom_t, rx_power_msb, PM_DOM_RX_POWER, 0),
+    PM_DOM_VALUE(pm_sfp_dom_t, tx_power_msb, PM_DOM_TX_POWER, 0),
+    PM_SFP_FLAGS(112, 7, PM_DOM_TEMPERATURE),
+    PM_SFP_FLAGS(112, 5, PM_DOM_VCC),
+    PM_SFP_FLAGS(112, 3, PM_DOM_TX_BIAS),
+    PM_SFP_FLAGS(113, 7, PM_DOM_RX_POWER),
+    PM_SFP_FLAGS(112, 1, PM_DOM_TX_POWER),
+};
+
+static const pm_dom_field_t pm_sfp_dom_thresholds[] = {
+    PM_DOM_THRESHOLDS(pm_sfp_dom_t, temp_high_alarm_msb, PM_DOM_TEMPERATURE),
+    PM_DOM_THRESHOLDS(pm_sfp_dom_t, voltage_high_alarm_msb, PM_DOM_VCC),
+    PM_DOM_THRESHOLDS(pm_sfp_dom_t, bias_high_alarm_msb, PM_DOM_TX_BIAS),
+    PM_DOM_THRESHOLDS(pm_sfp_dom_t, rx_power_high_alarm_msb, PM_DOM_RX_POWER),
+    PM_DOM_THRESHOLDS(pm_sfp_dom_t, tx_power_high_alarm_msb, PM_DOM_TX_POWER),
+};
+
+// QSFP modules have no tx power monitor, and the temperature and vcc
+// flags aren't reported
+static const pm_dom_field_t pm_qsfp_dom_live[] = {
+    PM_DOM_VALUE(pm_qsfp_dom_t, module_monitors.temp_msb, PM_DOM_TEMPERATURE, 0),
+    PM_DOM_VALUE(pm_qsfp_dom_t, module_monitors.voltage_msb, PM_DOM_VCC, 0),
+    PM_DOM_VALUE(pm_qsfp_dom_t, channel_monitors.tx1_bias_msb, PM_DOM_TX_BIAS, 0),
+    PM_DOM_VALUE(pm_qsfp_dom_t, channel_monitors.tx2_bias_msb, PM_DOM_TX_BIAS, 1),
+    PM_DOM_VALUE(pm_qsfp_dom_t, channel_monitors.tx3_bias_msb, PM_DOM_TX_BIAS, 2),
+    PM_DOM_VALUE(pm_qsfp_dom_t, channel_monitors.tx4_bias_msb, PM_DOM_TX_BIAS, 3),
+    PM_DOM_VALUE(pm_qsfp_dom_t, channel_monitors.rx1_power_msb, PM_DOM_RX_POWER, 0),
+    PM_DOM_VALUE(pm_qsfp_dom_t, channel_monitors.rx2_power_msb, PM_DOM_RX_POWER, 1),
+    PM_DOM_VALUE(pm_qsfp_dom_t, channel_monitors.rx3_power_msb, PM_DOM_RX_POWER, 2),
+    PM_DOM_VALUE(pm_qsfp_dom_t, channel_monitors.rx4_power_msb, PM_DOM_RX_POWER, 3),
+    PM_QSFP_FLAGS(9, 4, PM_DOM_RX_POWER, 0),
+    PM_QSFP_FLAGS(9, 0, PM_DOM_RX_POWER, 1),
+    PM_QSFP_FLAGS(10, 4, PM_DOM_RX_POWER, 2),
+    PM_QSFP_FLAGS(10, 0, PM_DOM_RX_POWER, 3),
+    PM_QSFP_FLAGS(11, 4, PM_DOM_TX_BIAS, 0),
+    PM_QSFP_FLAGS(11, 0, PM_DOM_TX_BIAS, 1),
+    PM_QSFP_FLAGS(12, 4, PM_DOM_TX_BIAS, 2),
+    PM_QSFP_FLAGS(12, 0, PM_DOM_TX_BIAS, 3),
+};
+
+// page 3 thresholds, shared by all lanes
+static const pm_dom_field_t pm_qsfp_dom_thresholds[] = {
+    PM_DOM_THRESHOLDS(pm_qsfp_dom_thresholds_t, temp_high_alarm_msb,
+                      PM_DOM_TEMPERATURE),
+    PM_DOM_THRESHOLDS(pm_qsfp_dom_thresholds_t, voltage_high_alarm_msb,
+                      PM_DOM_VCC),
+    PM_DOM_THRESHOLDS(pm_qsfp_dom_thresholds_t, bias_high_alarm_msb,
+                      PM_DOM_TX_BIAS),
+    PM_DOM_THRESHOLDS(pm_qsfp_dom_thresholds_t, rx_power_high_alarm_msb,
+                      PM_DOM_RX_POWER),
+};
+
+// DOM layout of a module class
+typedef struct {
+    uint8_t                 lanes;
+    size_t                  page_size;      /* size of the a2 data */
+    const pm_dom_field_t    *live;
+    size_t                  n_live;
+    const pm_dom_field_t    *thresholds;
+    size_t                  n_thresholds;
+} pm_dom_class_t;
+
+static const pm_dom_class_t pm_sfp_dom_class = {
+    1, sizeof(pm_sfp_dom_t),
+    pm_sfp_dom_live, ARRAY_SIZE(pm_sfp_dom_live),
+    pm_sfp_dom_thresholds, ARRAY_SIZE(pm_sfp_dom_thresholds),
+};
+
+static const pm_dom_class_t pm_qsfp_dom_class = {
+    PM_DOM_LANES, sizeof(pm_qsfp_dom_t),
+    pm_qsfp_dom_live, ARRAY_SIZE(pm_qsfp_dom_live),
+    pm_qsfp_dom_thresholds, ARRAY_SIZE(pm_qsfp_dom_thresholds),
+};
+
+/*
+ * pm_dom_class: get the DOM layout of a module type, NULL if unknown
+ */
+static const pm_dom_class_t *
+pm_dom_class(int module_type)
+{
+    switch (module_type) {
+        case MODULE_TYPE_SFP_PLUS:
+            return &pm_sfp_dom_class;
+        case MODULE_TYPE_QSFP_PLUS:
+        case MODULE_TYPE_QSFP28:
+            return &pm_qsfp_dom_class;
+        default:
+            return NULL;
+    }
+}
+
+/*
+ * pm_dom_decode: convert the fields of page data into a DOM store
+ *
+ * The fields are or'ed into the store, along with their valid bits.
+ */
+static void
+pm_dom_decode(pm_dom_store_t *dom, const pm_dom_field_t *fields,
+              size_t n_fields, const unsigned char *data)
+{
+    const pm_dom_field_t *field;
+    const pm_dom_field_t *end = fields + n_fields;
+
+    for (field = fields; field < end; field++) {
+        const unsigned char *byte = data + field->offset;
+        unsigned int bit = PM_DOM_MEASURE_BIT(field->measure);
+
+        switch (field->kind) {
+            case PM_DOM_FIELD_VALUE:
+                dom->value[field->measure][field->lane] =
+                    PM_DOM_RAW16(byte[0], byte[1]);
+                dom->values_valid |= bit;
+                break;
+            case PM_DOM_FIELD_FLAG:
+                if (*byte & (1u << field->bit)) {
+                    dom->flags[field->measure] |=
+                        PM_DOM_FLAG_BIT(field->lane, field->level);
+                }
+                dom->flags_valid |= bit;
+                break;
+            case PM_DOM_FIELD_THRESHOLD:
+                dom->threshold[field->measure][field->level] =
+                    PM_DOM_RAW16(byte[0], byte[1]);
+                dom->thresholds_valid |= bit;
+                break;
+        }
+    }
+}
+
+/*
+ * pm_dom_scaled: convert a raw value of a measure to its units
+ */
+static double
+pm_dom_scaled(enum pm_dom_measure measure, uint16_t raw)
+{
+    // temperatures are signed, in 1/256 degrees
+    if (PM_DOM_TEMPERATURE == measure) {
+        return (int16_t)raw * pm_dom_measures[measure].scale;
+    }
+
+    return raw * pm_dom_measures[measure].scale;
+}
+
+/*
+ * pm_dom_lanes: get the number of lanes a measure has values for
+ */
+static int
+pm_dom_lanes(const pm_dom_store_t *dom, enum pm_dom_measure measure)
+{
+    if (NULL != pm_dom_measures[measure].lane_format && dom->lanes > 1) {
+        return dom->lanes;
+    }
+
+    return 1;
+}
+
+/*
+ * pm_dom_significant: check if new DOM data differs enough from the
+ *                     published data to be published
+ */
+static bool
+pm_dom_significant(const pm_dom_store_t *published, const pm_dom_store_t *dom)
+{
+    int measure;
+    int lane;
+
+    if (published->lanes != dom->lanes ||
+        published->values_valid != dom->values_valid ||
+        published->flags_valid != dom->flags_valid ||
+        published->thresholds_valid != dom->thresholds_valid ||
+        0 != memcmp(published->flags, dom->flags, sizeof(dom->flags)) ||
+        0 != memcmp(published->threshold, dom->threshold,
+                    sizeof(dom->threshold))) {
+        return true;
+    }
+
+    for (measure = 0; measure < PM_DOM_MEASURE_MAX; measure++) {
+        if (0 == (dom->values_valid & PM_DOM_MEASURE_BIT(measure))) {
+            continue;
+        }
+
+        for (lane = 0; lane < pm_dom_lanes(dom, measure); lane++) {
+            double old = pm_dom_scaled(measure,
+                                       published->value[measure][lane]);
+            double new = pm_dom_scaled(measure, dom->value[measure][lane]);
+            double band = pm_dom_deadbands[measure].relative / 100 * fabs(old);
+
+            if (band < pm_dom_deadbands[measure].absolute) {
+                band = pm_dom_deadbands[measure].absolute;
+            }
+
+            if (fabs(new - old) > band) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/*
+ * pm_dom_changes: get the measures whose pm_info keys differ between two
+ *                 DOM stores
+ */
+static unsigned int
+pm_dom_changes(const pm_dom_store_t *old, const pm_dom_store_t *dom)
+{
+    unsigned int changes = 0;
+    int measure;
+
+    // a change of lanes changes the key names of all lane measures
+    if (old->lanes != dom->lanes) {
+        return PM_DOM_MEASURE_BIT(PM_DOM_MEASURE_MAX) - 1;
+    }
+
+    for (measure = 0; measure < PM_DOM_MEASURE_MAX; measure++) {
+        unsigned int bit = PM_DOM_MEASURE_BIT(measure);
+
+        if ((old->values_valid & bit) != (dom->values_valid & bit) ||
+            (old->flags_valid & bit) != (dom->flags_valid & bit) ||
+            (old->thresholds_valid & bit) != (dom->thresholds_valid & bit) ||
+            old->flags[measure] != dom->flags[measure] ||
+            0 != memcmp(old->value[measure], dom->value[measure],
+                        sizeof(dom->value[measure])) ||
+            0 != memcmp(old->threshold[measure], dom->threshold[measure],
+                        sizeof(dom->threshold[measure]))) {
+            changes |= bit;
+        }
+    }
+
+    return changes;
+}
+
+/*
+ * pm_dom_set: replace the DOM data of a port, and note the measures whose
+ *             keys must be written
+ */
+static void
+pm_dom_set(pm_port_t *port, const pm_dom_store_t *dom)
+{
+    port->cold->dom_dirty |= pm_dom_changes(&port->cold->dom, dom);
+    memcpy(&port->cold->dom, dom, sizeof(*dom));
+    pm_port_changed(port);
+}
+
+/*
+ * pm_dom_update: replace the DOM data of a port, if it has changed
+ */
+static void
+pm_dom_update(pm_port_t *port, const pm_dom_store_t *dom)
+{
+    if (0 != memcmp(&port->cold->dom, dom, sizeof(*dom))) {
+        pm_dom_set(port, dom);
+    }
+}
+
+/*
+ * pm_dom_publish: replace the DOM data of a port with new readings, if they
+ *                 have changed significantly
+ *
+ * Values within the deadbands keep the published data as is, so slow drift
+ * is published once it adds up to more than a deadband.
+ */
+static void
+pm_dom_publish(pm_port_t *port, const pm_dom_store_t *dom)
+{
+    if (pm_dom_significant(&port->cold->dom, dom)) {
+        pm_dom_set(port, dom);
+    }
+}
+
+/*
+ * pm_dom_clear: delete the DOM data of a port
+ */
+void
+pm_dom_clear(pm_port_t *port)
+{
+    pm_dom_store_t dom;
+
+    memset(&dom, 0, sizeof(dom));
+    pm_dom_update(port, &dom);
+}
+
 /*
  * pm_set_a2: set the a2 value (force, since it's on demand)
  */
 void
 pm_set_a2(pm_port_t *port, pm_sfp_dom_t *a2_data)
 {
-    int type;
-    float temperature, temp_high_alarm, temp_low_alarm,
-                       temp_high_warning, temp_low_warning,
-          vcc, voltage_high_alarm, voltage_low_alarm,
-               voltage_high_warning, voltage_low_warning,
-          tx_bias, bias_high_alarm, bias_low_alarm,
-                   bias_high_warning, bias_low_warning,
-          rx_power, rx_power_high_alarm, rx_power_low_alarm,
-                    rx_power_high_warning, rx_power_low_warning,
-          tx_power, tx_power_high_alarm, tx_power_low_alarm,
-                    tx_power_high_warning, tx_power_low_warning,
-          tx1_bias, tx2_bias, tx3_bias, tx4_bias,
-          rx1_power, rx2_power, rx3_power, rx4_power;
-    pm_qsfp_dom_t *qsfp_a2_data;
+    const pm_dom_class_t *dom_class;
+    pm_dom_store_t dom;
 
     // ignore modules that aren't pluggable
-    if (false == port->module_device->pluggable) {
+    if (false == port->cold->module_device->pluggable) {
         VLOG_DBG("port is not pluggable: %s", port->instance);
         return;
     }
 
     // ignore modules that don't have connector data
-    if (NULL == port->module_device->connector) {
+    if (NULL == port->cold->module_device->connector) {
         VLOG_WARN("no connector info for port: %s", port->instance);
         return;
     }
 
-    // prepare for handling SFP+ and QSFP differently
-    if (strcmp(port->module_device->connector, CONNECTOR_SFP_PLUS) == 0) {
-        type = MODULE_TYPE_SFP_PLUS;
-    } else if (strcmp(port->module_device->connector, CONNECTOR_QSFP_PLUS) == 0) {
-        type = MODULE_TYPE_QSFP_PLUS;
-    } else if (strcmp(port->module_device->connector, CONNECTOR_QSFP28) == 0) {
-        type = MODULE_TYPE_QSFP28;
-    } else {
+    dom_class = pm_dom_class(port->cold->access.module_type);
+    if (NULL == dom_class) {
         VLOG_WARN("unknown connector type for port: %s (%s)",
-                  port->instance, port->module_device->connector);
+                  port->instance, port->cold->module_device->connector);
 
-        // to-do: delete the dom information when the connector type is unknown
-        // pm_delete_all_dom_data(port);
+        pm_dom_clear(port);
         SET_STATIC_STRING(port, connector, OVSREC_INTERFACE_PM_INFO_CONNECTOR_UNKNOWN);
         return;
     }
 
-    switch (type) {
-        case MODULE_TYPE_SFP_PLUS:
-            // Parsing temperature value
-            temperature = (a2_data->temperature_msb +
-                          (float)(a2_data->temperature_lsb/256));
-            SET_FLOAT_STRING(port, temperature, temperature);
-
-            SET_BOOL_STRING(port, temperature_high_alarm,
-                            a2_data->alarm_warning_bits.temp_high_alarm);
-            SET_BOOL_STRING(port, temperature_low_alarm,
-                            a2_data->alarm_warning_bits.temp_low_alarm);
-            SET_BOOL_STRING(port, temperature_high_warning,
-                            a2_data->alarm_warning_bits.temp_high_warning);
-            SET_BOOL_STRING(port, temperature_low_warning,
-                            a2_data->alarm_warning_bits.temp_low_warning);
-
-            temp_high_alarm = (a2_data->temp_high_alarm_msb +
-                              (float)(a2_data->temp_high_alarm_lsb/256));
-            SET_FLOAT_STRING(port, temperature_high_alarm_threshold,
-                             temp_high_alarm);
-
-            temp_low_alarm = (a2_data->temp_low_alarm_msb +
-                             (float)(a2_data->temp_low_alarm_lsb/256));
-            SET_FLOAT_STRING(port, temperature_low_alarm_threshold,
-                             temp_low_alarm);
-
-            temp_high_warning = (a2_data->temp_high_warning_msb +
-                                (float)(a2_data->temp_high_warning_lsb/256));
-            SET_FLOAT_STRING(port, temperature_high_warning_threshold,
-                             temp_high_warning);
-
-            temp_low_warning = (a2_data->temp_low_warning_msb +
-                               (float)(a2_data->temp_low_warning_lsb/256));
-            SET_FLOAT_STRING(port, temperature_low_warning_threshold,
-                             temp_low_warning);
-
-
-            // Parsing Vcc value
-            vcc = (float) ((a2_data->vcc_msb<<8) |
-                  (a2_data->vcc_lsb)) * 0.0001;
-            SET_FLOAT_STRING(port, vcc, vcc);
-
-            SET_BOOL_STRING(port, vcc_high_alarm,
-                            a2_data->alarm_warning_bits.vcc_high_alarm);
-            SET_BOOL_STRING(port, vcc_low_alarm,
-                            a2_data->alarm_warning_bits.vcc_low_alarm);
-            SET_BOOL_STRING(port, vcc_high_warning,
-                            a2_data->alarm_warning_bits.vcc_high_warning);
-            SET_BOOL_STRING(port, vcc_low_warning,
-                            a2_data->alarm_warning_bits.vcc_low_warning);
-
-            voltage_high_alarm = (float) ((a2_data->voltage_high_alarm_msb<<8) |
-                                 (a2_data->voltage_high_alarm_lsb)) * 0.0001;
-            SET_FLOAT_STRING(port, vcc_high_alarm_threshold,
-                             voltage_high_alarm);
-
-            voltage_low_alarm = (float) ((a2_data->voltage_low_alarm_msb<<8) |
-                                (a2_data->voltage_low_alarm_lsb)) * 0.0001;
-            SET_FLOAT_STRING(port, vcc_low_alarm_threshold, voltage_low_alarm);
-
-            voltage_high_warning = (float) ((a2_data->voltage_high_warning_msb<<8) |
-                                   (a2_data->voltage_high_warning_lsb)) * 0.0001;
-            SET_FLOAT_STRING(port, vcc_high_warning_threshold, voltage_high_warning);
-
-            voltage_low_warning = (float) ((a2_data->voltage_low_warning_msb<<8) |
-                                  (a2_data->voltage_low_warning_lsb)) * 0.0001;
-            SET_FLOAT_STRING(port, vcc_low_warning_threshold, voltage_low_warning);
-
-
-            // Parsing tx_bias
-            tx_bias = (float) (a2_data->tx_bias_msb<<8 | a2_data->tx_bias_lsb) * 0.002;
-            SET_FLOAT_STRING(port, tx_bias, tx_bias);
-
-            SET_BOOL_STRING(port, tx_bias_high_alarm,
-                            a2_data->alarm_warning_bits.tx_bias_high_alarm);
-            SET_BOOL_STRING(port, tx_bias_low_alarm,
-                            a2_data->alarm_warning_bits.tx_bias_low_alarm);
-            SET_BOOL_STRING(port, tx_bias_high_warning,
-                            a2_data->alarm_warning_bits.tx_bias_high_warning);
-            SET_BOOL_STRING(port, tx_bias_low_warning,
-                            a2_data->alarm_warning_bits.tx_bias_low_warning);
-
-            bias_high_alarm = (float) (a2_data->bias_high_alarm_msb<<8 |
-                              a2_data->bias_high_alarm_lsb) * 0.002;
-            SET_FLOAT_STRING(port, tx_bias_high_alarm_threshold, bias_high_alarm);
-
-            bias_low_alarm = (float) (a2_data->bias_low_alarm_msb<<8 |
-                             a2_data->bias_low_alarm_lsb) * 0.002;
-            SET_FLOAT_STRING(port, tx_bias_low_alarm_threshold, bias_low_alarm);
-
-            bias_high_warning = (float) (a2_data->bias_high_warning_msb<<8 |
-                                a2_data->bias_high_warning_lsb) * 0.002;
-            SET_FLOAT_STRING(port, tx_bias_high_warning_threshold, bias_high_warning);
-
-            bias_low_warning = (float) (a2_data->bias_low_warning_msb<<8 |
-                               a2_data->bias_low_warning_lsb) * 0.002;
-            SET_FLOAT_STRING(port, tx_bias_low_warning_threshold, bias_low_warning);
-
-
-            // Parsing rx_power
-            rx_power = (float) (a2_data->rx_power_msb<<8 | a2_data->rx_power_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, rx_power, rx_power);
-
-            SET_BOOL_STRING(port, rx_power_high_alarm,
-                            a2_data->alarm_warning_bits.rx_pwr_high_alarm);
-            SET_BOOL_STRING(port, rx_power_low_alarm,
-                            a2_data->alarm_warning_bits.rx_pwr_low_alarm);
-            SET_BOOL_STRING(port, rx_power_high_warning,
-                            a2_data->alarm_warning_bits.rx_pwr_high_warning);
-            SET_BOOL_STRING(port, rx_power_low_warning,
-                            a2_data->alarm_warning_bits.rx_pwr_low_warning);
-
-            rx_power_high_alarm = (float) (a2_data->rx_power_high_alarm_msb<<8 |
-                                  a2_data->rx_power_high_alarm_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, rx_power_high_alarm_threshold, rx_power_high_alarm);
-
-            rx_power_low_alarm = (float) (a2_data->rx_power_low_alarm_msb<<8 |
-                                 a2_data->rx_power_low_alarm_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, rx_power_low_alarm_threshold, rx_power_low_alarm);
-
-            rx_power_high_warning = (float) (a2_data->rx_power_high_warning_msb<<8 |
-                                    a2_data->rx_power_high_warning_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, rx_power_high_warning_threshold, rx_power_high_warning);
-
-            rx_power_low_warning = (float) (a2_data->rx_power_low_warning_msb<<8 |
-                                   a2_data->rx_power_low_warning_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, rx_power_low_warning_threshold, rx_power_low_warning);
-
-
-            // Parsing tx_power
-            tx_power = (float) (a2_data->tx_power_msb<<8 | a2_data->tx_power_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, tx_power, tx_power);
-
-            SET_BOOL_STRING(port, tx_power_high_alarm,
-                            a2_data->alarm_warning_bits.tx_pwr_high_alarm);
-            SET_BOOL_STRING(port, tx_power_low_alarm,
-                            a2_data->alarm_warning_bits.tx_pwr_low_alarm);
-            SET_BOOL_STRING(port, tx_power_high_warning,
-                            a2_data->alarm_warning_bits.tx_pwr_high_warning);
-            SET_BOOL_STRING(port, tx_power_low_warning,
-                            a2_data->alarm_warning_bits.tx_pwr_low_warning);
-
-            tx_power_high_alarm = (float) (a2_data->tx_power_high_alarm_msb<<8 |
-                                   a2_data->tx_power_high_alarm_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, tx_power_high_alarm_threshold, tx_power_high_alarm);
-
-            tx_power_low_alarm = (float) (a2_data->tx_power_low_alarm_msb<<8 |
-                                 a2_data->tx_power_low_alarm_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, tx_power_low_alarm_threshold, tx_power_low_alarm);
-
-            tx_power_high_warning = (float) (a2_data->tx_power_high_warning_msb<<8 |
-                                    a2_data->tx_power_high_warning_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, tx_power_high_warning_threshold, tx_power_high_warning);
-
-            tx_power_low_warning = (float) (a2_data->tx_power_low_warning_msb<<8 |
-                                   a2_data->tx_power_low_warning_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, tx_power_low_warning_threshold, tx_power_low_warning);
-
+    // the thresholds are kept, they are set by pm_set_a2_thresholds
+    memcpy(&dom, &port->cold->dom, sizeof(dom));
+    memset(dom.value, 0, sizeof(dom.value));
+    memset(dom.flags, 0, sizeof(dom.flags));
+    dom.values_valid = 0;
+    dom.flags_valid = 0;
+    dom.lanes = dom_class->lanes;
 
-            SET_BINARY(port, a2, (char *)a2_data, sizeof(pm_sfp_dom_t));
-            break;
-        case MODULE_TYPE_QSFP_PLUS:
-        case MODULE_TYPE_QSFP28:
-            qsfp_a2_data = (pm_qsfp_dom_t *) a2_data;
-
-            // Parsing temperature value
-            temperature = (qsfp_a2_data->module_monitors.temp_msb +
-                          (float)(qsfp_a2_data->module_monitors.temp_lsb/256));
-            SET_FLOAT_STRING(port, temperature, temperature);
-
-            // Parsing Vcc value
-            vcc = (float) ((qsfp_a2_data->module_monitors.voltage_msb<<8) |
-                           (qsfp_a2_data->module_monitors.voltage_lsb)) * 0.0001;
-            SET_FLOAT_STRING(port, vcc, vcc);
-
-            // Bias current and received power for each lane split
-            //
-            // Lane 1
-            // Parsing tx_bias
-            tx1_bias = (float) (qsfp_a2_data->channel_monitors.tx1_bias_msb<<8 |
-                                qsfp_a2_data->channel_monitors.tx1_bias_lsb) * 0.002;
-            SET_FLOAT_STRING(port, tx1_bias, tx1_bias);
-
-            SET_BOOL_STRING(port, tx1_bias_high_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_tx1_bias_high_alarm);
-            SET_BOOL_STRING(port, tx1_bias_low_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_tx1_bias_low_alarm);
-            SET_BOOL_STRING(port, tx1_bias_high_warning,
-                            qsfp_a2_data->interrupt_flags.latched_tx1_bias_high_warning);
-            SET_BOOL_STRING(port, tx1_bias_low_warning,
-                            qsfp_a2_data->interrupt_flags.latched_tx1_bias_low_warning);
-
-            // Parsing rx_power
-            rx1_power = (float) (qsfp_a2_data->channel_monitors.rx1_power_msb<<8 |
-                                 qsfp_a2_data->channel_monitors.rx1_power_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, rx1_power, rx1_power);
-
-            SET_BOOL_STRING(port, rx1_power_high_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_rx1_power_high_alarm);
-            SET_BOOL_STRING(port, rx1_power_low_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_rx1_power_low_alarm);
-            SET_BOOL_STRING(port, rx1_power_high_warning,
-                            qsfp_a2_data->interrupt_flags.latched_rx1_power_high_warning);
-            SET_BOOL_STRING(port, rx1_power_low_warning,
-                            qsfp_a2_data->interrupt_flags.latched_rx1_power_low_warning);
-
-            // Lane 2
-            //
-            // Parsing tx_bias
-            tx2_bias = (float) (qsfp_a2_data->channel_monitors.tx2_bias_msb<<8 |
-                                qsfp_a2_data->channel_monitors.tx2_bias_lsb) * 0.002;
-            SET_FLOAT_STRING(port, tx2_bias, tx2_bias);
-
-            SET_BOOL_STRING(port, tx2_bias_high_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_tx2_bias_high_alarm);
-            SET_BOOL_STRING(port, tx2_bias_low_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_tx2_bias_low_alarm);
-            SET_BOOL_STRING(port, tx2_bias_high_warning,
-                            qsfp_a2_data->interrupt_flags.latched_tx2_bias_high_warning);
-            SET_BOOL_STRING(port, tx2_bias_low_warning,
-                            qsfp_a2_data->interrupt_flags.latched_tx2_bias_low_warning);
-
-
-            // Parsing rx_power
-            rx2_power = (float) (qsfp_a2_data->channel_monitors.rx2_power_msb<<8 |
-                                 qsfp_a2_data->channel_monitors.rx2_power_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, rx2_power, rx2_power);
-
-            SET_BOOL_STRING(port, rx2_power_high_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_rx2_power_high_alarm);
-            SET_BOOL_STRING(port, rx2_power_low_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_rx2_power_low_alarm);
-            SET_BOOL_STRING(port, rx2_power_high_warning,
-                            qsfp_a2_data->interrupt_flags.latched_rx2_power_high_warning);
-            SET_BOOL_STRING(port, rx2_power_low_warning,
-                            qsfp_a2_data->interrupt_flags.latched_rx2_power_low_warning);
-
-            // Lane 3
-            //
-            // Parsing tx_bias
-            tx3_bias = (float) (qsfp_a2_data->channel_monitors.tx3_bias_msb<<8 |
-                                qsfp_a2_data->channel_monitors.tx3_bias_lsb) * 0.002;
-            SET_FLOAT_STRING(port, tx3_bias, tx3_bias);
-
-            SET_BOOL_STRING(port, tx3_bias_high_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_tx3_bias_high_alarm);
-            SET_BOOL_STRING(port, tx3_bias_low_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_tx3_bias_low_alarm);
-            SET_BOOL_STRING(port, tx3_bias_high_warning,
-                            qsfp_a2_data->interrupt_flags.latched_tx3_bias_high_warning);
-            SET_BOOL_STRING(port, tx3_bias_low_warning,
-                            qsfp_a2_data->interrupt_flags.latched_tx3_bias_low_warning);
-
-
-            // Parsing rx_power
-            rx3_power = (float) (qsfp_a2_data->channel_monitors.rx3_power_msb<<8 |
-                                 qsfp_a2_data->channel_monitors.rx3_power_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, rx3_power, rx3_power);
-
-            SET_BOOL_STRING(port, rx3_power_high_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_rx3_power_high_alarm);
-            SET_BOOL_STRING(port, rx3_power_low_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_rx3_power_low_alarm);
-            SET_BOOL_STRING(port, rx3_power_high_warning,
-                            qsfp_a2_data->interrupt_flags.latched_rx3_power_high_warning);
-            SET_BOOL_STRING(port, rx3_power_low_warning,
-                            qsfp_a2_data->interrupt_flags.latched_rx3_power_low_warning);
-
-
-            // Lane 4
-            //
-            // Parsing tx_bias
-            tx4_bias = (float) (qsfp_a2_data->channel_monitors.tx4_bias_msb<<8 |
-                                qsfp_a2_data->channel_monitors.tx4_bias_lsb) * 0.002;
-            SET_FLOAT_STRING(port, tx4_bias, tx4_bias);
-
-            SET_BOOL_STRING(port, tx4_bias_high_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_tx4_bias_high_alarm);
-            SET_BOOL_STRING(port, tx4_bias_low_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_tx4_bias_low_alarm);
-            SET_BOOL_STRING(port, tx4_bias_high_warning,
-                            qsfp_a2_data->interrupt_flags.latched_tx4_bias_high_warning);
-            SET_BOOL_STRING(port, tx4_bias_low_warning,
-                            qsfp_a2_data->interrupt_flags.latched_tx4_bias_low_warning);
-
-
-            // Parsing rx_power
-            rx4_power = (float) (qsfp_a2_data->channel_monitors.rx4_power_msb<<8 |
-                                 qsfp_a2_data->channel_monitors.rx4_power_lsb) * 0.0001;
-            SET_FLOAT_STRING(port, rx4_power, rx4_power);
-
-            SET_BOOL_STRING(port, rx4_power_high_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_rx4_power_high_alarm);
-            SET_BOOL_STRING(port, rx4_power_low_alarm,
-                            qsfp_a2_data->interrupt_flags.latched_rx4_power_low_alarm);
-            SET_BOOL_STRING(port, rx4_power_high_warning,
-                            qsfp_a2_data->interrupt_flags.latched_rx4_power_high_warning);
-            SET_BOOL_STRING(port, rx4_power_low_warning,
-                            qsfp_a2_data->interrupt_flags.latched_rx4_power_low_warning);
-
-
-            SET_BINARY(port, a2, (char *)qsfp_a2_data, sizeof(pm_qsfp_dom_t));
-            break;
+    pm_dom_decode(&dom, dom_class->live, dom_class->n_live,
+                  (const unsigned char *)a2_data);
+
+    pm_dom_publish(port, &dom);
+
+    // only live values are read, fill in the SFP thresholds for the dump
+    if (MODULE_TYPE_SFP_PLUS == port->cold->access.module_type &&
+        port->dom_thresholds_valid) {
+        memcpy(a2_data, port->cold->dom_thresholds.sfp,
+               sizeof(port->cold->dom_thresholds.sfp));
+    }
+
+    SET_BINARY(port, a2, (char *)a2_data, dom_class->page_size);
+}
+
+
+/*
+ * pm_set_a2_thresholds: set the DOM alarm and warning thresholds, which are
+ *                       read once per module
+ */
+void
+pm_set_a2_thresholds(pm_port_t *port, const pm_dom_thresholds_t *thresholds)
+{
+    const pm_dom_class_t *dom_class;
+    pm_dom_store_t dom;
+
+    dom_class = pm_dom_class(port->cold->access.module_type);
+    if (NULL == dom_class) {
+        return;
+    }
+
+    memcpy(&dom, &port->cold->dom, sizeof(dom));
+    memset(dom.threshold, 0, sizeof(dom.threshold));
+    dom.thresholds_valid = 0;
+    dom.lanes = dom_class->lanes;
+
+    // SFP thresholds are the first bytes of the A2 data, QSFP thresholds
+    // are on page 3
+    pm_dom_decode(&dom, dom_class->thresholds, dom_class->n_thresholds,
+                  (const unsigned char *)thresholds);
+
+    pm_dom_update(port, &dom);
+}
+
+/*
+ * pm_dom_render_keys: render the keys of one name of a measure (the measure
+ *                     name, or a lane name)
+ *
+ * Keys of a name that isn't in the data (present is false), or of parts of
+ * the measure that aren't valid, are put with a NULL value if deletes is
+ * set, and skipped otherwise.
+ */
+static void
+pm_dom_render_keys(const pm_dom_store_t *dom, int measure, const char *name,
+                   int lane, bool present, bool deletes, pm_dom_put_t put,
+                   void *aux)
+{
+    unsigned int bit = PM_DOM_MEASURE_BIT(measure);
+    char key[64];
+    char value[32];
+    int level;
+
+    if (present && (dom->values_valid & bit)) {
+        snprintf(value, sizeof(value), "%4.2f",
+                 pm_dom_scaled(measure, dom->value[measure][lane]));
+        put(name, value, aux);
+    } else if (deletes) {
+        put(name, NULL, aux);
+    }
+
+    for (level = 0; level < PM_DOM_LEVEL_MAX; level++) {
+        snprintf(key, sizeof(key), "%s_%s", name, pm_dom_levels[level]);
+        if (present && (dom->flags_valid & bit)) {
+            put(key, (dom->flags[measure] &
+                      PM_DOM_FLAG_BIT(lane, level)) ? "On" : "Off",
+                aux);
+        } else if (deletes) {
+            put(key, NULL, aux);
+        }
+    }
+
+    for (level = 0; level < PM_DOM_LEVEL_MAX; level++) {
+        snprintf(key, sizeof(key), "%s_%s_threshold", name,
+                 pm_dom_levels[level]);
+        if (present && (dom->thresholds_valid & bit)) {
+            snprintf(value, sizeof(value), "%4.2f",
+                     pm_dom_scaled(measure, dom->threshold[measure][level]));
+            put(key, value, aux);
+        } else if (deletes) {
+            put(key, NULL, aux);
+        }
+    }
+}
+
+/*
+ * pm_dom_render_measure: render the keys of a measure
+ *
+ * With deletes set, the keys of the other naming (measure name instead of
+ * lane names, or the other way around) are put with a NULL value as well.
+ */
+static void
+pm_dom_render_measure(const pm_dom_store_t *dom, int measure, bool deletes,
+                      pm_dom_put_t put, void *aux)
+{
+    const char *lane_format = pm_dom_measures[measure].lane_format;
+    char name[32];
+    int lanes;
+    int lane;
+
+    lanes = pm_dom_lanes(dom, measure);
+
+    for (lane = 0; lane < lanes; lane++) {
+        if (lanes > 1) {
+            snprintf(name, sizeof(name), lane_format, lane + 1);
+        } else {
+            snprintf(name, sizeof(name), "%s", pm_dom_measures[measure].name);
+        }
+        pm_dom_render_keys(dom, measure, name, lane, true, deletes, put, aux);
+    }
+
+    if (!deletes || NULL == lane_format) {
+        return;
+    }
+
+    if (lanes > 1) {
+        pm_dom_render_keys(dom, measure, pm_dom_measures[measure].name, 0,
+                           false, true, put, aux);
+    } else {
+        for (lane = 0; lane < PM_DOM_LANES; lane++) {
+            snprintf(name, sizeof(name), lane_format, lane + 1);
+            pm_dom_render_keys(dom, measure, name, lane, false, true, put,
+                               aux);
+        }
+    }
+}
+
+/*
+ * pm_dom_render: render the DOM data as key/value strings
+ *
+ * Keys are the pm_info keys, e.g. "temperature", "tx_bias_high_alarm" and
+ * "rx2_power_low_warning_threshold". The strings passed to put are only
+ * valid during the call.
+ */
+void
+pm_dom_render(const pm_dom_store_t *dom, pm_dom_put_t put, void *aux)
+{
+    int measure;
+
+    for (measure = 0; measure < PM_DOM_MEASURE_MAX; measure++) {
+        pm_dom_render_measure(dom, measure, false, put, aux);
+    }
+}
+
+/*
+ * pm_dom_render_changes: render all pm_info keys of some measures, for an
+ *                        incremental update of pm_info
+ *
+ * Keys that must be removed from pm_info are put with a NULL value.
+ */
+void
+pm_dom_render_changes(const pm_dom_store_t *dom, unsigned int measures,
+                      pm_dom_put_t put, void *aux)
+{
+    int measure;
+
+    for (measure = 0; measure < PM_DOM_MEASURE_MAX; measure++) {
+        if (measures & PM_DOM_MEASURE_BIT(measure)) {
+            pm_dom_render_measure(dom, measure, true, put, aux);
+        }
+    }
+}
+
+static void
+pm_dom_put_smap(const char *key, const char *value, void *smap_)
+{
+    smap_add((struct smap *)smap_, key, value);
+}
+
+/*
+ * pm_dom_to_smap: add the DOM data to a pm_info map
+ */
+void
+pm_dom_to_smap(const pm_dom_store_t *dom, struct smap *smap)
+{
+    pm_dom_render(dom, pm_dom_put_smap, smap);
+}
+
+static void
+pm_dom_put_ds(const char *key, const char *value, void *ds_)
+{
+    ds_put_format((struct ds *)ds_, "    %-22s = %s\n", key, value);
+}
+
+/*
+ * pm_dom_dump: add the DOM data to a dump
+ */
+void
+pm_dom_dump(const pm_dom_store_t *dom, struct ds *ds)
+{
+    pm_dom_render(dom, pm_dom_put_ds, ds);
+}
+
+static int
+pm_dom_find_measure(const char *name)
+{
+    int measure;
+
+    for (measure = 0; measure < PM_DOM_MEASURE_MAX; measure++) {
+        if (0 == strcasecmp(pm_dom_measures[measure].name, name)) {
+            return measure;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * pm_dom_set_deadband: change the publishing deadband of a DOM measure
+ *
+ * input: measure name, absolute deadband (in the measure's units),
+ *        relative deadband (in percent)
+ *
+ * output: 0 on success, -1 on invalid input (error message in ds)
+ */
+int
+pm_dom_set_deadband(const char *measure_name, const char *absolute,
+                    const char *relative, struct ds *ds)
+{
+    double abs_band;
+    double rel_band;
+    char *end;
+    int measure;
+
+    measure = pm_dom_find_measure(measure_name);
+    if (measure < 0) {
+        ds_put_format(ds, "Unknown measure: %s", measure_name);
+        return -1;
+    }
+
+    abs_band = strtod(absolute, &end);
+    if (end == absolute || '\0' != *end || !isfinite(abs_band) || abs_band < 0) {
+        ds_put_format(ds, "Invalid absolute deadband: %s", absolute);
+        return -1;
+    }
+
+    rel_band = strtod(relative, &end);
+    if (end == relative || '\0' != *end || !isfinite(rel_band) || rel_band < 0) {
+        ds_put_format(ds, "Invalid relative deadband: %s", relative);
+        return -1;
+    }
+
+    pm_dom_deadbands[measure].absolute = abs_band;
+    pm_dom_deadbands[measure].relative = rel_band;
+
+    ds_put_format(ds, "%s deadband set to %g, %g%%",
+                  pm_dom_measures[measure].name, abs_band, rel_band);
+
+    return 0;
+}
+
+/*
+ * pm_dom_dump_deadbands: show the publishing deadbands of all DOM measures
+ */
+void
+pm_dom_dump_deadbands(struct ds *ds)
+{
+    int measure;
+
+    ds_put_format(ds, "%-12s %12s %12s\n", "measure", "absolute", "relative");
+
+    for (measure = 0; measure < PM_DOM_MEASURE_MAX; measure++) {
+        ds_put_format(ds, "%-12s %12g %11g%%\n", pm_dom_measures[measure].name,
+                      pm_dom_deadbands[measure].absolute,
+                      pm_dom_deadbands[measure].relative);
     }
 }
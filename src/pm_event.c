@@ -0,0 +1,561 @@
+/*
+ *  (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License. You may obtain
+ *  a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *  License for the specific language governing permissions and limitations
+ *  under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-pmd
+ *
+ * @file
+ * Source file for event driven pluggable module detection.
+ *
+ * Module presence and interrupt (IntL) edges are taken from sysfs GPIO
+ * value files listed in the subsystem's hw description directory, and are
+ * waited on in the poll loop. A port with an event is scheduled to be read
+ * right away. Periodic presence polling is only kept as a slow safety net
+ * for ports that have a presence source; other ports are polled as usual.
+ * Sources are kept by path, and belong to the subsystem whose file lists
+ * them.
+ *
+ * Simulation builds use a FIFO in the run directory instead: writing an
+ * interface name to it generates an event for that interface. The FIFO is
+ * a presence source for all ports.
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <dirs.h>
+#include <poll-loop.h>
+#include <shash.h>
+#include <sset.h>
+
+#include "pmd.h"
+
+VLOG_DEFINE_THIS_MODULE(pm_event);
+
+
+// event source list, in the hw description directory
+#define PM_EVENTS_FILE          "pm_events.conf"
+
+// simulation event FIFO, in the run directory
+#define PM_EVENTS_SIM_FIFO      "ops-pmd.events"
+
+struct pm_event_source {
+    char    *subsystem;         /* owner, NULL for the simulation FIFO */
+    char    *instance;          /* interface, NULL if named by the data */
+    char    *signal;            /* "presence" or "intl" */
+    char    *path;
+    int     fd;
+    short   events;             /* POLLPRI for GPIO, POLLIN for a FIFO */
+};
+
+// path -> struct pm_event_source
+static struct shash event_sources = SHASH_INITIALIZER(&event_sources);
+
+// interface -> number of its presence sources
+static struct shash presence_sources = SHASH_INITIALIZER(&presence_sources);
+
+// presence sources that can name any interface (the simulation FIFO)
+static size_t any_presence_sources = 0;
+
+// interfaces with an event that haven't been read, yet
+static struct sset pending_events = SSET_INITIALIZER(&pending_events);
+
+// poll set of all event sources, rebuilt when sources change
+static struct pollfd *event_pfds = NULL;
+static struct pm_event_source **event_pfd_sources = NULL;
+static size_t n_event_pfds = 0;
+static bool event_pfds_valid = false;
+
+//
+// pm_event_covers: check if an interface has a presence event source
+//
+// input: interface name
+//
+// output: true if insertion and removal are signaled for the interface
+//
+bool
+pm_event_covers(const char *instance)
+{
+    return (0 != any_presence_sources ||
+            NULL != shash_find(&presence_sources, instance));
+}
+
+//
+// pm_event_cover: count a presence source of an interface in or out, and
+//                 update the port's schedule if its coverage changed
+//
+static void
+pm_event_cover(const char *instance, bool add)
+{
+    struct shash_node *node = shash_find(&presence_sources, instance);
+    uintptr_t count = (NULL == node) ? 0 : (uintptr_t)node->data;
+    pm_port_t *port;
+
+    if (add) {
+        count++;
+    } else if (count > 0) {
+        count--;
+    }
+
+    if (0 == count) {
+        if (NULL != node) {
+            shash_delete(&presence_sources, node);
+        }
+    } else if (NULL == node) {
+        shash_add(&presence_sources, instance, (void *)count);
+    } else {
+        node->data = (void *)count;
+    }
+
+    port = pm_port_find(instance);
+    if (NULL != port) {
+        pm_sched_set_events(port, pm_event_covers(instance));
+    }
+}
+
+static struct pm_event_source *
+pm_event_add_source(const char *subsystem, const char *instance,
+                    const char *signal, const char *path, int fd,
+                    short events)
+{
+    struct pm_event_source *source;
+
+    source = xzalloc(sizeof(*source));
+    source->subsystem = (NULL == subsystem) ? NULL : xstrdup(subsystem);
+    source->instance = (NULL == instance) ? NULL : xstrdup(instance);
+    source->signal = xstrdup(signal);
+    source->path = xstrdup(path);
+    source->fd = fd;
+    source->events = events;
+
+    shash_add(&event_sources, path, source);
+    event_pfds_valid = false;
+
+    if (0 == strcmp(signal, "presence")) {
+        if (NULL == instance) {
+            any_presence_sources++;
+        } else {
+            pm_event_cover(instance, true);
+        }
+    }
+
+    return source;
+}
+
+static void
+pm_event_remove_source(struct shash_node *node)
+{
+    struct pm_event_source *source = node->data;
+
+    shash_delete(&event_sources, node);
+    event_pfds_valid = false;
+
+    if (0 == strcmp(source->signal, "presence")) {
+        if (NULL == source->instance) {
+            any_presence_sources--;
+        } else {
+            pm_event_cover(source->instance, false);
+        }
+    }
+
+    close(source->fd);
+    free(source->subsystem);
+    free(source->instance);
+    free(source->signal);
+    free(source->path);
+    free(source);
+}
+
+//
+// pm_event_arm_gpio: read the current value of a GPIO, which is required
+//                    before the next edge is reported
+//
+static void
+pm_event_arm_gpio(int fd)
+{
+    char buf[8];
+
+    lseek(fd, 0, SEEK_SET);
+    if (read(fd, buf, sizeof(buf)) < 0) {
+        VLOG_DBG("gpio value read failed: %s", ovs_strerror(errno));
+    }
+}
+
+//
+// pm_event_open_gpio: open a sysfs GPIO value file for edge events
+//
+static int
+pm_event_open_gpio(const char *path)
+{
+    const char *slash;
+    int fd;
+
+    // enable both edges, if the GPIO allows it (it may be set up already)
+    slash = strrchr(path, '/');
+    if (NULL != slash) {
+        char *edge_path;
+        FILE *fp;
+
+        edge_path = xasprintf("%.*s/edge", (int)(slash - path), path);
+        fp = fopen(edge_path, "w");
+        if (NULL != fp) {
+            fputs("both", fp);
+            fclose(fp);
+        }
+        free(edge_path);
+    }
+
+    fd = open(path, O_RDONLY | O_NONBLOCK);
+    if (fd < 0) {
+        return -1;
+    }
+
+    pm_event_arm_gpio(fd);
+
+    return fd;
+}
+
+#ifdef PLATFORM_SIMULATION
+//
+// pm_event_open_sim: create the simulation event FIFO
+//
+static void
+pm_event_open_sim(void)
+{
+    char *path;
+    int fd;
+
+    path = xasprintf("%s/%s", ovs_rundir(), PM_EVENTS_SIM_FIFO);
+
+    if (mkfifo(path, 0600) != 0 && EEXIST != errno) {
+        VLOG_WARN("unable to create event FIFO %s: %s", path,
+                  ovs_strerror(errno));
+        free(path);
+        return;
+    }
+
+    // open read/write, so there is always a writer and no hangups
+    fd = open(path, O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+        VLOG_WARN("unable to open event FIFO %s: %s", path,
+                  ovs_strerror(errno));
+        free(path);
+        return;
+    }
+
+    pm_event_add_source(NULL, NULL, "presence", path, fd, POLLIN);
+
+    VLOG_INFO("simulation module events from %s", path);
+
+    free(path);
+}
+#endif
+
+//
+// pm_event_init: initialize event driven module detection
+//
+// input: none
+//
+// output: none
+//
+void
+pm_event_init(void)
+{
+#ifdef PLATFORM_SIMULATION
+    pm_event_open_sim();
+#endif
+}
+
+//
+// pm_event_remove_subsystem: close the module event sources of a subsystem
+//
+// input: subsystem name
+//
+// output: none
+//
+void
+pm_event_remove_subsystem(const char *subsystem)
+{
+    struct shash_node *node;
+    struct shash_node *next;
+
+    SHASH_FOR_EACH_SAFE (node, next, &event_sources) {
+        struct pm_event_source *source = node->data;
+
+        if (NULL != source->subsystem &&
+            0 == strcmp(source->subsystem, subsystem)) {
+            pm_event_remove_source(node);
+        }
+    }
+}
+
+//
+// pm_event_read_config: read the module event sources for a subsystem
+//
+// input: subsystem name, hw description directory of the subsystem
+//
+// output: 0 (ports without a usable source are found by the periodic scan)
+//
+// The file has one source per line: "<interface> <presence|intl> <path>",
+// where path is a sysfs GPIO value file. Blank lines and lines starting
+// with '#' are ignored. Sources read before for the subsystem are replaced,
+// and a path can only be used by one source.
+//
+int
+pm_event_read_config(const char *subsystem, const char *hw_desc_dir)
+{
+    char *file_name;
+    char line[512];
+    FILE *fp;
+    int line_no = 0;
+    size_t n_sources = 0;
+
+    pm_event_remove_subsystem(subsystem);
+
+    file_name = xasprintf("%s/%s", hw_desc_dir, PM_EVENTS_FILE);
+
+    fp = fopen(file_name, "r");
+    if (NULL == fp) {
+        // no event sources, use periodic polling
+        VLOG_DBG("no module event sources in %s", hw_desc_dir);
+        free(file_name);
+        return 0;
+    }
+
+    while (NULL != fgets(line, sizeof(line), fp)) {
+        char instance[128];
+        char signal[16];
+        char path[256];
+        int fd;
+
+        line_no++;
+
+        if ('#' == line[0] || '\n' == line[0]) {
+            continue;
+        }
+
+        if (3 != sscanf(line, "%127s %15s %255s", instance, signal, path)) {
+            VLOG_WARN("%s:%d: invalid event source", file_name, line_no);
+            continue;
+        }
+
+        if (0 != strcmp(signal, "presence") && 0 != strcmp(signal, "intl")) {
+            VLOG_WARN("%s:%d: unknown signal %s", file_name, line_no, signal);
+            continue;
+        }
+
+        if (NULL != shash_find(&event_sources, path)) {
+            VLOG_WARN("%s:%d: %s is already an event source", file_name,
+                      line_no, path);
+            continue;
+        }
+
+        fd = pm_event_open_gpio(path);
+        if (fd < 0) {
+            VLOG_WARN("%s:%d: unable to open %s: %s", file_name, line_no,
+                      path, ovs_strerror(errno));
+            continue;
+        }
+
+        pm_event_add_source(subsystem, instance, signal, path, fd, POLLPRI);
+        n_sources++;
+    }
+
+    fclose(fp);
+
+    VLOG_INFO("%zu module event sources for subsystem %s", n_sources,
+              subsystem);
+
+    free(file_name);
+
+    return 0;
+}
+
+//
+// pm_event_notify: request an immediate presence check of an interface
+//
+void
+pm_event_notify(const char *instance)
+{
+    sset_add(&pending_events, instance);
+    poll_immediate_wake();
+}
+
+//
+// pm_event_read_sim: read interface names written to the event FIFO
+//
+static void
+pm_event_read_sim(struct pm_event_source *source)
+{
+    char buf[1024];
+    ssize_t len;
+
+    while ((len = read(source->fd, buf, sizeof(buf) - 1)) > 0) {
+        char *save_ptr = NULL;
+        char *name;
+
+        buf[len] = '\0';
+
+        for (name = strtok_r(buf, " \t\r\n", &save_ptr); NULL != name;
+             name = strtok_r(NULL, " \t\r\n", &save_ptr)) {
+            sset_add(&pending_events, name);
+        }
+    }
+}
+
+//
+// pm_event_trigger: make the tasks for an event due on a port
+//
+static void
+pm_event_trigger(const char *instance, const char *signal)
+{
+    pm_port_t *port = pm_port_find(instance);
+
+    if (NULL == port) {
+        VLOG_DBG("event for unknown interface: %s", instance);
+        return;
+    }
+
+    VLOG_DBG("%s event: %s", signal, instance);
+
+    if (0 == strcmp(signal, "intl")) {
+        // interrupts report diagnostic alarms and warnings
+        pm_sched_trigger(port, PM_TASK_DOM);
+    } else {
+        pm_sched_trigger(port, PM_TASK_PRESENCE);
+        pm_sched_trigger(port, PM_TASK_IDENTITY);
+    }
+}
+
+//
+// pm_event_build_pfds: build the poll set of all event sources
+//
+static void
+pm_event_build_pfds(void)
+{
+    struct shash_node *node;
+    size_t n = 0;
+
+    n_event_pfds = shash_count(&event_sources);
+    event_pfds = xrealloc(event_pfds, n_event_pfds * sizeof *event_pfds);
+    event_pfd_sources = xrealloc(event_pfd_sources,
+                                 n_event_pfds * sizeof *event_pfd_sources);
+
+    SHASH_FOR_EACH (node, &event_sources) {
+        struct pm_event_source *source = node->data;
+
+        event_pfds[n].fd = source->fd;
+        event_pfds[n].events = source->events;
+        event_pfd_sources[n] = source;
+        n++;
+    }
+
+    event_pfds_valid = true;
+}
+
+//
+// pm_event_run: collect module events, and schedule the affected ports to
+//               be read right away
+//
+// input: none
+//
+// output: none
+//
+// All sources are checked with a single poll() call.
+//
+void
+pm_event_run(void)
+{
+    const char *name;
+    size_t i;
+
+    if (!event_pfds_valid) {
+        pm_event_build_pfds();
+    }
+
+    if (0 != n_event_pfds && poll(event_pfds, n_event_pfds, 0) > 0) {
+        for (i = 0; i < n_event_pfds; i++) {
+            struct pm_event_source *source = event_pfd_sources[i];
+
+            if (0 == (event_pfds[i].revents & source->events)) {
+                continue;
+            }
+
+            if (NULL == source->instance) {
+                pm_event_read_sim(source);
+            } else {
+                pm_event_arm_gpio(source->fd);
+                pm_event_trigger(source->instance, source->signal);
+            }
+        }
+    }
+
+    SSET_FOR_EACH(name, &pending_events) {
+        pm_event_trigger(name, "presence");
+    }
+    sset_clear(&pending_events);
+}
+
+//
+// pm_event_wait: wait for module events
+//
+void
+pm_event_wait(void)
+{
+    struct shash_node *node;
+
+    SHASH_FOR_EACH (node, &event_sources) {
+        struct pm_event_source *source = node->data;
+
+        poll_fd_wait(source->fd, source->events);
+    }
+
+    if (!sset_is_empty(&pending_events)) {
+        poll_immediate_wake();
+    }
+}
+
+//
+// pm_event_destroy: close all event sources
+//
+void
+pm_event_destroy(void)
+{
+    struct shash_node *node;
+    struct shash_node *next;
+
+    SHASH_FOR_EACH_SAFE (node, next, &event_sources) {
+        pm_event_remove_source(node);
+    }
+
+    shash_destroy(&presence_sources);
+    sset_destroy(&pending_events);
+
+    free(event_pfds);
+    free(event_pfd_sources);
+    event_pfds = NULL;
+    event_pfd_sources = NULL;
+    n_event_pfds = 0;
+    event_pfds_valid = false;
+}
@@ -0,0 +1,116 @@
+/*
+ *  (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License. You may obtain
+ *  a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *  License for the specific language governing permissions and limitations
+ *  under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-pmd
+ *
+ * @file
+ * Source file for the interned string pool.
+ *
+ * Module data that is the same for many ports (vendor name, part number,
+ * speeds) is kept once for the daemon. An interned string is shared and
+ * must not be modified; two interned strings are equal if and only if
+ * their pointers are.
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+
+#include <hash.h>
+#include <hmap.h>
+#include <util.h>
+
+#include "pmd.h"
+
+VLOG_DEFINE_THIS_MODULE(pm_intern);
+
+struct pm_intern {
+    struct hmap_node node;          /* in pm_intern_pool */
+    unsigned int    refs;
+    char            str[];
+};
+
+static struct hmap pm_intern_pool = HMAP_INITIALIZER(&pm_intern_pool);
+
+//
+// pm_intern: get the interned copy of a string
+//
+// input: string
+//
+// output: interned string, with a reference the caller must release with
+//         pm_intern_unref
+//
+const char *
+pm_intern(const char *str)
+{
+    struct pm_intern *atom;
+    uint32_t hash = hash_string(str, 0);
+    size_t len;
+
+    HMAP_FOR_EACH_WITH_HASH (atom, node, hash, &pm_intern_pool) {
+        if (0 == strcmp(atom->str, str)) {
+            atom->refs++;
+            return atom->str;
+        }
+    }
+
+    len = strlen(str) + 1;
+    atom = xmalloc(sizeof(*atom) + len);
+    atom->refs = 1;
+    memcpy(atom->str, str, len);
+    hmap_insert(&pm_intern_pool, &atom->node, hash);
+
+    return atom->str;
+}
+
+//
+// pm_intern_unref: release a reference to an interned string
+//
+// input: interned string (NULL is ignored)
+//
+// output: none
+//
+void
+pm_intern_unref(const char *str)
+{
+    struct pm_intern *atom;
+
+    if (NULL == str) {
+        return;
+    }
+
+    atom = CONTAINER_OF(str, struct pm_intern, str);
+    if (0 == --atom->refs) {
+        hmap_remove(&pm_intern_pool, &atom->node);
+        free(atom);
+    }
+}
+
+//
+// pm_intern_dump: show the interned strings and their reference counts
+//
+void
+pm_intern_dump(struct ds *ds)
+{
+    struct pm_intern *atom;
+
+    ds_put_format(ds, "%zu interned strings\n", hmap_count(&pm_intern_pool));
+
+    HMAP_FOR_EACH (atom, node, &pm_intern_pool) {
+        ds_put_format(ds, "    %4u  %s\n", atom->refs, atom->str);
+    }
+}
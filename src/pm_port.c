@@ -0,0 +1,299 @@
+/*
+ *  (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License. You may obtain
+ *  a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *  License for the specific language governing permissions and limitations
+ *  under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-pmd
+ *
+ * @file
+ * Source file for the port table.
+ *
+ * Ports are kept in cache line aligned slots of fixed size chunks, so they
+ * are contiguous in memory and never move. A port's id is its slot index:
+ * it is small, stable while the port exists, and can index per-port side
+ * tables. Ids of deleted ports are reused. The interface name is mapped to
+ * the id for lookups by name, and ports are indexed by the uuid of their
+ * Interface row for the database code.
+ *
+ * Each port is split in two: the hot pm_port_t, one cache line, and its
+ * pm_port_cold_t, in a parallel slot of its own. Scans of the port table
+ * only touch the hot records, and bus worker threads writing a port's scan
+ * results (in the cold record) don't share cache lines with other ports.
+ *
+ * Ports with module data to write to the database are kept in a list, so
+ * the database update only visits the ports that have changed.
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <hmap.h>
+#include <list.h>
+#include <shash.h>
+#include <util.h>
+#include <uuid.h>
+
+#include "pmd.h"
+
+VLOG_DEFINE_THIS_MODULE(pm_port);
+
+#define PM_PORTS_PER_CHUNK  32
+
+typedef union {
+    pm_port_t   port;
+    uint8_t     pad[ROUND_UP(sizeof(pm_port_t), CACHE_LINE_SIZE)];
+} pm_port_slot_t;
+
+typedef union {
+    pm_port_cold_t  cold;
+    uint8_t         pad[ROUND_UP(sizeof(pm_port_cold_t), CACHE_LINE_SIZE)];
+} pm_port_cold_slot_t;
+
+// the hot part of a port must stay within one cache line
+BUILD_ASSERT_DECL(sizeof(pm_port_t) <= CACHE_LINE_SIZE);
+
+static pm_port_slot_t **pm_port_chunks = NULL;
+static pm_port_cold_slot_t **pm_port_cold_chunks = NULL;
+static size_t pm_port_n_chunks = 0;
+static size_t pm_port_allocated_chunks = 0;
+
+// all port ids are below pm_port_n
+static size_t pm_port_n = 0;
+
+// interface name -> port id + 1 (so that id 0 isn't a NULL pointer)
+static struct shash pm_port_names = SHASH_INITIALIZER(&pm_port_names);
+
+// Interface row uuid -> port (uuid_node of the cold record)
+static struct hmap pm_port_uuids = HMAP_INITIALIZER(&pm_port_uuids);
+
+// ports with module_info_changed set, in the order they changed
+static struct ovs_list pm_port_changed_list =
+    OVS_LIST_INITIALIZER(&pm_port_changed_list);
+
+static pm_port_t *
+pm_port_slot(size_t id)
+{
+    return &pm_port_chunks[id / PM_PORTS_PER_CHUNK][id % PM_PORTS_PER_CHUNK].port;
+}
+
+//
+// pm_port_alloc: add a port to the port table
+//
+// input: interface name, uuid of the Interface row
+//
+// output: zeroed port (and cold record), with its id, instance and uuid set
+//
+pm_port_t *
+pm_port_alloc(const char *instance, const struct uuid *uuid)
+{
+    pm_port_t *port;
+    size_t id;
+
+    // reuse the lowest free id
+    for (id = 0; id < pm_port_n; id++) {
+        if (NULL == pm_port_slot(id)->instance) {
+            break;
+        }
+    }
+
+    if (id == pm_port_n) {
+        if (id == pm_port_n_chunks * PM_PORTS_PER_CHUNK) {
+            if (pm_port_n_chunks == pm_port_allocated_chunks) {
+                size_t allocated = pm_port_allocated_chunks;
+
+                pm_port_chunks = x2nrealloc(pm_port_chunks,
+                                            &pm_port_allocated_chunks,
+                                            sizeof(*pm_port_chunks));
+                pm_port_cold_chunks = x2nrealloc(pm_port_cold_chunks,
+                                                 &allocated,
+                                                 sizeof(*pm_port_cold_chunks));
+            }
+            pm_port_chunks[pm_port_n_chunks] =
+                xzalloc_cacheline(PM_PORTS_PER_CHUNK * sizeof(pm_port_slot_t));
+            pm_port_cold_chunks[pm_port_n_chunks] =
+                xzalloc_cacheline(PM_PORTS_PER_CHUNK *
+                                  sizeof(pm_port_cold_slot_t));
+            pm_port_n_chunks++;
+        }
+        pm_port_n++;
+    }
+
+    port = pm_port_slot(id);
+    memset(port, 0, sizeof(*port));
+    port->cold = &pm_port_cold_chunks[id / PM_PORTS_PER_CHUNK]
+                                     [id % PM_PORTS_PER_CHUNK].cold;
+    memset(port->cold, 0, sizeof(*port->cold));
+    port->cold->port = port;
+    port->id = id;
+    port->instance = xstrdup(instance);
+
+    shash_add(&pm_port_names, port->instance, (void *)(uintptr_t)(id + 1));
+    port->cold->uuid = *uuid;
+    hmap_insert(&pm_port_uuids, &port->cold->uuid_node, uuid_hash(uuid));
+
+    return port;
+}
+
+//
+// pm_port_free: remove a port from the port table
+//
+// input: port, which must not be used afterwards
+//
+// output: none
+//
+void
+pm_port_free(pm_port_t *port)
+{
+    if (port->module_info_changed) {
+        list_remove(&port->cold->changed_node);
+    }
+    if (port->txn_pending) {
+        list_remove(&port->cold->txn_node);
+    }
+
+    shash_find_and_delete(&pm_port_names, port->instance);
+    hmap_remove(&pm_port_uuids, &port->cold->uuid_node);
+    free(port->instance);
+    memset(port->cold, 0, sizeof(*port->cold));
+    memset(port, 0, sizeof(*port));
+
+    while (pm_port_n > 0 && NULL == pm_port_slot(pm_port_n - 1)->instance) {
+        pm_port_n--;
+    }
+}
+
+//
+// pm_port_find: find a port by interface name
+//
+// input: interface name
+//
+// output: port, or NULL if there is no such port
+//
+pm_port_t *
+pm_port_find(const char *instance)
+{
+    uintptr_t id = (uintptr_t)shash_find_data(&pm_port_names, instance);
+
+    if (0 == id) {
+        return NULL;
+    }
+
+    return pm_port_slot(id - 1);
+}
+
+//
+// pm_port_find_by_uuid: find a port by the uuid of its Interface row
+//
+// input: uuid
+//
+// output: port, or NULL if there is no such port
+//
+pm_port_t *
+pm_port_find_by_uuid(const struct uuid *uuid)
+{
+    pm_port_cold_t *cold;
+
+    HMAP_FOR_EACH_WITH_HASH (cold, uuid_node, uuid_hash(uuid),
+                             &pm_port_uuids) {
+        if (uuid_equals(&cold->uuid, uuid)) {
+            return cold->port;
+        }
+    }
+
+    return NULL;
+}
+
+//
+// pm_port_next: get the first port with an id at or above *id
+//
+// input: id to start at
+//
+// output: port (and its id in *id), or NULL if there are no more ports
+//
+pm_port_t *
+pm_port_next(size_t *id)
+{
+    for (; *id < pm_port_n; (*id)++) {
+        pm_port_t *port = pm_port_slot(*id);
+
+        if (NULL != port->instance) {
+            return port;
+        }
+    }
+
+    return NULL;
+}
+
+//
+// pm_port_id_limit: get the size of a table indexed by port id
+//
+size_t
+pm_port_id_limit(void)
+{
+    return pm_port_n;
+}
+
+//
+// pm_port_changed: note that a port has module data to write to the
+//                  database
+//
+// input: port
+//
+// output: none
+//
+void
+pm_port_changed(pm_port_t *port)
+{
+    if (!port->module_info_changed) {
+        port->module_info_changed = true;
+        list_push_back(&pm_port_changed_list, &port->cold->changed_node);
+    }
+}
+
+//
+// pm_port_pop_changed: take the port that changed first off the changed
+//                      port list
+//
+// input: none
+//
+// output: port, with module_info_changed cleared, or NULL if no port has
+//         changed
+//
+pm_port_t *
+pm_port_pop_changed(void)
+{
+    pm_port_cold_t *cold;
+
+    if (list_is_empty(&pm_port_changed_list)) {
+        return NULL;
+    }
+
+    cold = CONTAINER_OF(list_pop_front(&pm_port_changed_list),
+                        pm_port_cold_t, changed_node);
+    cold->port->module_info_changed = false;
+
+    return cold->port;
+}
+
+//
+// pm_port_any_changed: check if any port has module data to write
+//
+bool
+pm_port_any_changed(void)
+{
+    return !list_is_empty(&pm_port_changed_list);
+}
@@ -0,0 +1,563 @@
+/*
+ *  (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License. You may obtain
+ *  a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *  License for the specific language governing permissions and limitations
+ *  under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-pmd
+ *
+ * @file
+ * Source file for the pluggable module scan engine.
+ *
+ * Ports are grouped by the i2c adapter tree their module is accessed
+ * through: all buses a port's devices are on, including the buses of the
+ * mux devices selected by the devices' pre/post operations, are joined into
+ * one tree, and trees that share a bus are merged. Channels of one mux share
+ * its parent adapter and select register, so they are always scanned by the
+ * same thread. With scan threads enabled (ops-pmd/scan-threads on), each
+ * tree is scanned by its own worker thread, so a sweep takes as long as the
+ * slowest tree instead of the sum of all ports. The main thread scans the
+ * first tree itself and waits for the workers, then processes all of the
+ * results (parsing, OVSDB data) on its own. By default, the main thread
+ * scans all trees. Only ports with tasks due in the scheduler (pm_sched.c)
+ * are read.
+ *
+ * The workers call the config-yaml i2c functions concurrently on the shared
+ * global_yaml_handle, for devices on different adapters. This assumes those
+ * functions only read the handle's device data, which isn't changed while
+ * workers run (subsystems are added on the main thread, between sweeps),
+ * and keep no state shared between adapters. To keep any state config-yaml
+ * sets up on first use of an adapter single threaded, the first sweep after
+ * the ports are regrouped is done by the main thread alone. Until
+ * config-yaml's thread safety is confirmed, the workers are off by default.
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+
+#include <ovs-thread.h>
+#include <shash.h>
+#include <timeval.h>
+
+#include "pmd.h"
+
+VLOG_DEFINE_THIS_MODULE(pm_scan);
+
+extern YamlConfigHandle global_yaml_handle;
+
+// ports that share an i2c adapter tree and are scanned by the same thread
+struct pm_scan_bus {
+    char            *name;          /* a bus of the tree */
+    pm_port_t       **ports;
+    size_t          n_ports;
+    size_t          allocated;
+    pthread_t       thread;         /* worker, unused for the first bus */
+};
+
+static struct pm_scan_bus *scan_buses = NULL;
+static size_t n_scan_buses = 0;
+
+// bus groups need to be rebuilt (ports added or removed)
+static bool scan_groups_valid = false;
+
+// workers are started after the first sweep of new groups
+static bool scan_threads_wanted = false;
+
+// trees are scanned by worker threads, off by default
+static bool scan_threads_enabled = false;
+
+// mux devices are followed this many levels up to the root adapter
+#define PM_SCAN_MAX_MUX_DEPTH   4
+
+// bus names joined into adapter trees (union-find over bus indexes)
+struct pm_scan_trees {
+    struct shash    names;          /* bus name -> bus index + 1 */
+    size_t          *parent;
+    size_t          n_buses;
+    size_t          allocated;
+};
+
+// worker synchronization: the main thread and all workers meet at
+// scan_start to begin a sweep, and at scan_done when it is complete.
+static struct ovs_barrier scan_start;
+static struct ovs_barrier scan_done;
+static bool scan_threads_running = false;
+static bool scan_exiting = false;
+
+//
+// pm_scan_tree_bus: get the index of a bus, adding it as a tree of its own
+//                   if it's new
+//
+static size_t
+pm_scan_tree_bus(struct pm_scan_trees *trees, const char *name)
+{
+    size_t bus_idx = (size_t)shash_find_data(&trees->names, name);
+
+    if (0 != bus_idx) {
+        return bus_idx - 1;
+    }
+
+    if (trees->n_buses == trees->allocated) {
+        trees->parent = x2nrealloc(trees->parent, &trees->allocated,
+                                   sizeof(*trees->parent));
+    }
+    bus_idx = trees->n_buses++;
+    trees->parent[bus_idx] = bus_idx;
+    shash_add(&trees->names, name, (void *)(bus_idx + 1));
+
+    return bus_idx;
+}
+
+//
+// pm_scan_tree_root: get the root bus index of a bus's tree
+//
+static size_t
+pm_scan_tree_root(struct pm_scan_trees *trees, size_t bus_idx)
+{
+    while (trees->parent[bus_idx] != bus_idx) {
+        trees->parent[bus_idx] = trees->parent[trees->parent[bus_idx]];
+        bus_idx = trees->parent[bus_idx];
+    }
+
+    return bus_idx;
+}
+
+static void
+pm_scan_tree_join(struct pm_scan_trees *trees, size_t bus_a, size_t bus_b)
+{
+    bus_a = pm_scan_tree_root(trees, bus_a);
+    bus_b = pm_scan_tree_root(trees, bus_b);
+
+    if (bus_a != bus_b) {
+        trees->parent[bus_b] = bus_a;
+    }
+}
+
+//
+// pm_scan_join_device: join the bus of a device, and the buses of the mux
+//                      devices its pre/post operations select, to a tree
+//
+static void
+pm_scan_join_device(struct pm_scan_trees *trees, const char *subsystem,
+                    const YamlDevice *device, size_t bus_idx, int depth)
+{
+    i2c_op **ops[2];
+    size_t idx;
+    size_t op;
+
+    if (NULL == device || NULL == device->bus) {
+        return;
+    }
+
+    pm_scan_tree_join(trees, bus_idx,
+                      pm_scan_tree_bus(trees, device->bus));
+
+    if (depth >= PM_SCAN_MAX_MUX_DEPTH) {
+        return;
+    }
+
+    ops[0] = device->pre;
+    ops[1] = device->post;
+
+    for (idx = 0; idx < ARRAY_SIZE(ops); idx++) {
+        for (op = 0; NULL != ops[idx] && NULL != ops[idx][op]; op++) {
+            if (NULL == ops[idx][op]->device) {
+                continue;
+            }
+            pm_scan_join_device(trees, subsystem,
+                                yaml_find_device(global_yaml_handle, subsystem,
+                                                 ops[idx][op]->device),
+                                bus_idx, depth + 1);
+        }
+    }
+}
+
+static void
+pm_scan_join_signal(struct pm_scan_trees *trees, const char *subsystem,
+                    const i2c_bit_op *signal, size_t bus_idx)
+{
+    if (NULL == signal || NULL == signal->device) {
+        return;
+    }
+
+    pm_scan_join_device(trees, subsystem,
+                        yaml_find_device(global_yaml_handle, subsystem,
+                                         signal->device),
+                        bus_idx, 0);
+}
+
+//
+// pm_scan_port_tree: join all buses a port's module is accessed through
+//
+// input: trees, port structure
+//
+// output: index of a bus of the port's tree, or SIZE_MAX for ports without
+//         i2c devices
+//
+static size_t
+pm_scan_port_tree(struct pm_scan_trees *trees, const pm_port_t *port)
+{
+    const pm_access_plan_t *access = &port->cold->access;
+    const char *subsystem = port->cold->subsystem;
+    size_t bus_idx;
+
+    if (NULL == access->a0_device || NULL == access->a0_device->bus) {
+        return SIZE_MAX;
+    }
+
+    bus_idx = pm_scan_tree_bus(trees, access->a0_device->bus);
+
+    pm_scan_join_device(trees, subsystem, access->a0_device, bus_idx, 0);
+    pm_scan_join_device(trees, subsystem, access->a2_device, bus_idx, 0);
+    pm_scan_join_signal(trees, subsystem, access->presence_op, bus_idx);
+    pm_scan_join_signal(trees, subsystem, access->reset_op, bus_idx);
+    pm_scan_join_signal(trees, subsystem, access->tx_disable_op, bus_idx);
+
+    return bus_idx;
+}
+
+//
+// pm_scan_bus_io: do the hardware reads for all ports on a bus
+//
+static void
+pm_scan_bus_io(struct pm_scan_bus *bus)
+{
+    size_t idx;
+
+    for (idx = 0; idx < bus->n_ports; idx++) {
+        // only read ports with scheduled tasks
+        if (0 != bus->ports[idx]->sched_due) {
+            pm_read_module_io(bus->ports[idx]);
+        }
+    }
+}
+
+static void *
+pm_scan_worker(void *bus_)
+{
+    struct pm_scan_bus *bus = (struct pm_scan_bus *)bus_;
+
+    for (;;) {
+        ovs_barrier_block(&scan_start);
+        if (scan_exiting) {
+            break;
+        }
+        pm_scan_bus_io(bus);
+        ovs_barrier_block(&scan_done);
+    }
+
+    return NULL;
+}
+
+static void
+pm_scan_stop_threads(void)
+{
+    size_t idx;
+
+    if (false == scan_threads_running) {
+        return;
+    }
+
+    scan_exiting = true;
+    ovs_barrier_block(&scan_start);
+
+    for (idx = 1; idx < n_scan_buses; idx++) {
+        xpthread_join(scan_buses[idx].thread, NULL);
+    }
+
+    ovs_barrier_destroy(&scan_start);
+    ovs_barrier_destroy(&scan_done);
+
+    scan_exiting = false;
+    scan_threads_running = false;
+}
+
+static void
+pm_scan_start_threads(void)
+{
+    size_t idx;
+
+    // a single tree is scanned by the main thread alone
+    if (!scan_threads_enabled || n_scan_buses < 2) {
+        return;
+    }
+
+    ovs_barrier_init(&scan_start, n_scan_buses);
+    ovs_barrier_init(&scan_done, n_scan_buses);
+
+    for (idx = 1; idx < n_scan_buses; idx++) {
+        scan_buses[idx].thread = ovs_thread_create("pm_scan", pm_scan_worker,
+                                                   &scan_buses[idx]);
+    }
+
+    scan_threads_running = true;
+
+    VLOG_DBG("started %zu scan workers", n_scan_buses - 1);
+}
+
+static void
+pm_scan_free_groups(void)
+{
+    size_t idx;
+
+    for (idx = 0; idx < n_scan_buses; idx++) {
+        free(scan_buses[idx].name);
+        free(scan_buses[idx].ports);
+    }
+    free(scan_buses);
+
+    scan_buses = NULL;
+    n_scan_buses = 0;
+}
+
+//
+// pm_scan_add_group: add an empty port group for a bus
+//
+static struct pm_scan_bus *
+pm_scan_add_group(const char *name, size_t *allocated)
+{
+    struct pm_scan_bus *bus;
+
+    if (n_scan_buses == *allocated) {
+        scan_buses = x2nrealloc(scan_buses, allocated, sizeof(*scan_buses));
+    }
+    bus = &scan_buses[n_scan_buses++];
+    memset(bus, 0, sizeof(*bus));
+    bus->name = xstrdup(name);
+
+    return bus;
+}
+
+static void
+pm_scan_group_add_port(struct pm_scan_bus *bus, pm_port_t *port)
+{
+    if (bus->n_ports == bus->allocated) {
+        bus->ports = x2nrealloc(bus->ports, &bus->allocated,
+                                sizeof(*bus->ports));
+    }
+    bus->ports[bus->n_ports++] = port;
+}
+
+//
+// pm_scan_rebuild: regroup all ports by adapter tree
+//
+// Ports without i2c devices don't need a worker of their own, they are
+// added to the first group, which the main thread scans.
+//
+// The workers are started again after the next sweep (see
+// pm_scan_start_threads).
+//
+static void
+pm_scan_rebuild(void)
+{
+    struct pm_scan_trees trees;
+    struct shash_node *node;
+    pm_port_t *port;
+    size_t id;
+    struct pm_scan_bus *bus;
+    const char *name;
+    size_t allocated = 0;
+    size_t *port_buses;
+    size_t *tree_groups;
+    size_t bus_idx;
+
+    pm_scan_stop_threads();
+    pm_scan_free_groups();
+
+    shash_init(&trees.names);
+    trees.parent = NULL;
+    trees.n_buses = 0;
+    trees.allocated = 0;
+
+    // join the buses of all ports first, a later port can merge the trees
+    // of earlier ones
+    port_buses = xcalloc(pm_port_id_limit() + 1, sizeof(*port_buses));
+    PM_PORT_FOR_EACH(port, id) {
+        port_buses[id] = pm_scan_port_tree(&trees, port);
+    }
+
+    // group index + 1 of each root bus
+    tree_groups = xcalloc(trees.n_buses + 1, sizeof(*tree_groups));
+
+    PM_PORT_FOR_EACH(port, id) {
+        if (SIZE_MAX == port_buses[id]) {
+            continue;
+        }
+
+        bus_idx = pm_scan_tree_root(&trees, port_buses[id]);
+
+        if (0 == tree_groups[bus_idx]) {
+            name = "";
+            SHASH_FOR_EACH (node, &trees.names) {
+                if ((size_t)node->data - 1 == bus_idx) {
+                    name = node->name;
+                    break;
+                }
+            }
+            pm_scan_add_group(name, &allocated);
+            tree_groups[bus_idx] = n_scan_buses;
+        }
+
+        pm_scan_group_add_port(&scan_buses[tree_groups[bus_idx] - 1], port);
+    }
+
+    PM_PORT_FOR_EACH(port, id) {
+        if (SIZE_MAX == port_buses[id]) {
+            bus = (0 == n_scan_buses) ? pm_scan_add_group("", &allocated)
+                                      : &scan_buses[0];
+            pm_scan_group_add_port(bus, port);
+        }
+    }
+
+    VLOG_DBG("%zu ports on %zu buses in %zu adapter trees",
+             pm_port_id_limit(), trees.n_buses, n_scan_buses);
+
+    free(tree_groups);
+    free(port_buses);
+    free(trees.parent);
+    shash_destroy(&trees.names);
+
+    scan_threads_wanted = true;
+    scan_groups_valid = true;
+}
+
+//
+// pm_scan_invalidate: ports have been added or removed, regroup on the
+//                     next sweep
+//
+void
+pm_scan_invalidate(void)
+{
+    scan_groups_valid = false;
+    pm_presence_invalidate();
+}
+
+//
+// pm_scan_run: scan the pluggable modules with due tasks and process the
+//              results
+//
+// input: none
+//
+// output: success only
+//
+int
+pm_scan_run(void)
+{
+    unsigned int tasks;
+    size_t bus_idx;
+    size_t idx;
+
+    if (0 == pm_sched_run(time_msec(), &tasks)) {
+        return 0;
+    }
+
+    if (false == scan_groups_valid) {
+        pm_scan_rebuild();
+    } else if (scan_threads_wanted) {
+        scan_threads_wanted = false;
+        pm_scan_start_threads();
+    }
+
+    // presence bits are shared between ports, read them all up front
+    if (tasks & PM_TASK_BIT(PM_TASK_PRESENCE)) {
+        pm_read_presence();
+    }
+
+    if (scan_threads_running) {
+        ovs_barrier_block(&scan_start);
+        pm_scan_bus_io(&scan_buses[0]);
+        ovs_barrier_block(&scan_done);
+    } else {
+        for (bus_idx = 0; bus_idx < n_scan_buses; bus_idx++) {
+            pm_scan_bus_io(&scan_buses[bus_idx]);
+        }
+    }
+
+    // hand the results back to the main thread for processing
+    for (bus_idx = 0; bus_idx < n_scan_buses; bus_idx++) {
+        struct pm_scan_bus *bus = &scan_buses[bus_idx];
+
+        for (idx = 0; idx < bus->n_ports; idx++) {
+            pm_port_t *port = bus->ports[idx];
+
+            if (0 != port->sched_due) {
+                pm_read_module_update(port);
+                if (port->sched_due & PM_TASK_BIT(PM_TASK_RESET)) {
+                    pm_reset_run(port);
+                }
+                port->sched_due = 0;
+            }
+        }
+    }
+
+    return 0;
+}
+
+//
+// pm_scan_set_threads: enable or disable the scan worker threads
+//
+// input: "on" or "off"
+//
+// output: 0 on success, -1 on invalid input (error message in ds)
+//
+// Enabled workers start with the next sweep. Disabled workers are stopped
+// right away, and the main thread scans all trees.
+//
+int
+pm_scan_set_threads(const char *state, struct ds *ds)
+{
+    if (0 == strcmp(state, "on")) {
+        if (!scan_threads_enabled) {
+            scan_threads_enabled = true;
+            scan_threads_wanted = true;
+        }
+    } else if (0 == strcmp(state, "off")) {
+        scan_threads_enabled = false;
+        pm_scan_stop_threads();
+    } else {
+        ds_put_format(ds, "Invalid scan threads state: %s", state);
+        return -1;
+    }
+
+    ds_put_format(ds, "scan threads %s", state);
+
+    return 0;
+}
+
+//
+// pm_scan_dump_threads: show the scan worker threads
+//
+void
+pm_scan_dump_threads(struct ds *ds)
+{
+    ds_put_format(ds, "scan threads: %s\n",
+                  scan_threads_enabled ? "on" : "off");
+    ds_put_format(ds, "adapter trees: %zu\n", n_scan_buses);
+    ds_put_format(ds, "workers running: %zu\n",
+                  scan_threads_running ? n_scan_buses - 1 : 0);
+}
+
+//
+// pm_scan_destroy: stop the scan workers
+//
+void
+pm_scan_destroy(void)
+{
+    pm_scan_stop_threads();
+    pm_scan_free_groups();
+    pm_presence_destroy();
+    scan_groups_valid = false;
+    scan_threads_wanted = false;
+}
@@ -0,0 +1,447 @@
+/*
+ *  (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License. You may obtain
+ *  a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *  License for the specific language governing permissions and limitations
+ *  under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-pmd
+ *
+ * @file
+ * Source file for the pluggable module task scheduler.
+ *
+ * Every port has one entry per periodic task (presence, identity retry,
+ * DOM, thresholds) in a min-heap of deadlines. Each pass marks the tasks
+ * that are due on their ports and reschedules them at the cadence of the
+ * port's connector class; the main loop sleeps until the earliest deadline.
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dynamic-string.h>
+#include <shash.h>
+#include <timeval.h>
+
+#include "pmd.h"
+
+VLOG_DEFINE_THIS_MODULE(pm_sched);
+
+
+// entry is not in the heap (task disabled)
+#define PM_SCHED_IDLE   SIZE_MAX
+
+static const char *pm_class_names[PM_CLASS_MAX] = {
+    [PM_CLASS_SFPP]     = CONNECTOR_SFP_PLUS,
+    [PM_CLASS_QSFPP]    = CONNECTOR_QSFP_PLUS,
+    [PM_CLASS_QSFP28]   = CONNECTOR_QSFP28,
+};
+
+static const char *pm_task_names[PM_TASK_MAX] = {
+    [PM_TASK_PRESENCE]      = "presence",
+    [PM_TASK_IDENTITY]      = "identity",
+    [PM_TASK_DOM]           = "dom",
+    [PM_TASK_THRESHOLDS]    = "thresholds",
+    [PM_TASK_RESET]         = "reset",
+};
+
+// task cadences in msecs, 0 disables a task (one-shot tasks, like reset,
+// have no cadence)
+static long long int pm_cadence[PM_CLASS_MAX][PM_TASK_MAX] = {
+    [PM_CLASS_SFPP]     = { PM_INTERVAL, 2000, 5000, 60000, 0 },
+    [PM_CLASS_QSFPP]    = { PM_INTERVAL, 2000, 5000, 60000, 0 },
+    [PM_CLASS_QSFP28]   = { PM_INTERVAL, 2000, 5000, 60000, 0 },
+};
+
+// periodic tasks, which have a cadence
+#define PM_TASK_PERIODIC_MAX    PM_TASK_RESET
+
+// min-heap of task entries, ordered by deadline
+static pm_sched_entry_t **sched_heap = NULL;
+static size_t sched_heap_n = 0;
+static size_t sched_heap_allocated = 0;
+
+static enum pm_task
+pm_sched_entry_task(const pm_sched_entry_t *entry)
+{
+    return (enum pm_task)(entry - entry->port->cold->sched);
+}
+
+static void
+pm_sched_heap_set(size_t idx, pm_sched_entry_t *entry)
+{
+    sched_heap[idx] = entry;
+    entry->idx = idx;
+}
+
+static void
+pm_sched_sift_up(size_t idx)
+{
+    pm_sched_entry_t *entry = sched_heap[idx];
+
+    while (idx > 0) {
+        size_t parent = (idx - 1) / 2;
+
+        if (sched_heap[parent]->due <= entry->due) {
+            break;
+        }
+        pm_sched_heap_set(idx, sched_heap[parent]);
+        idx = parent;
+    }
+    pm_sched_heap_set(idx, entry);
+}
+
+static void
+pm_sched_sift_down(size_t idx)
+{
+    pm_sched_entry_t *entry = sched_heap[idx];
+
+    for (;;) {
+        size_t child = 2 * idx + 1;
+
+        if (child >= sched_heap_n) {
+            break;
+        }
+        if (child + 1 < sched_heap_n &&
+            sched_heap[child + 1]->due < sched_heap[child]->due) {
+            child++;
+        }
+        if (entry->due <= sched_heap[child]->due) {
+            break;
+        }
+        pm_sched_heap_set(idx, sched_heap[child]);
+        idx = child;
+    }
+    pm_sched_heap_set(idx, entry);
+}
+
+static void
+pm_sched_heap_insert(pm_sched_entry_t *entry)
+{
+    if (sched_heap_n == sched_heap_allocated) {
+        sched_heap = x2nrealloc(sched_heap, &sched_heap_allocated,
+                                sizeof(*sched_heap));
+    }
+    pm_sched_heap_set(sched_heap_n++, entry);
+    pm_sched_sift_up(entry->idx);
+}
+
+static void
+pm_sched_heap_remove(pm_sched_entry_t *entry)
+{
+    size_t idx = entry->idx;
+
+    if (PM_SCHED_IDLE == idx) {
+        return;
+    }
+
+    entry->idx = PM_SCHED_IDLE;
+    sched_heap_n--;
+
+    if (idx != sched_heap_n) {
+        pm_sched_entry_t *moved = sched_heap[sched_heap_n];
+
+        pm_sched_heap_set(idx, moved);
+        pm_sched_sift_up(idx);
+        pm_sched_sift_down(moved->idx);
+    }
+}
+
+//
+// pm_sched_set_due: move a task entry to a new deadline
+//
+static void
+pm_sched_set_due(pm_sched_entry_t *entry, long long int due)
+{
+    entry->due = due;
+
+    if (PM_SCHED_IDLE == entry->idx) {
+        pm_sched_heap_insert(entry);
+    } else {
+        pm_sched_sift_up(entry->idx);
+        pm_sched_sift_down(entry->idx);
+    }
+}
+
+//
+// pm_sched_cadence: get the cadence of a task for a port
+//
+static long long int
+pm_sched_cadence(const pm_port_t *port, enum pm_task task)
+{
+    long long int cadence = pm_cadence[port->sched_class][task];
+
+    // with presence events, polling is only a safety net
+    if (PM_TASK_PRESENCE == task && port->presence_events &&
+        cadence != 0 && cadence < PM_EVENT_SWEEP_INTERVAL) {
+        cadence = PM_EVENT_SWEEP_INTERVAL;
+    }
+
+    return cadence;
+}
+
+//
+// pm_sched_add_port: schedule all tasks of a new port, due immediately
+//
+// input: port structure
+//
+// output: none
+//
+void
+pm_sched_add_port(pm_port_t *port)
+{
+    long long int now = time_msec();
+    int task;
+
+    switch (port->cold->access.module_type) {
+    case MODULE_TYPE_QSFP_PLUS:
+        port->sched_class = PM_CLASS_QSFPP;
+        break;
+    case MODULE_TYPE_QSFP28:
+        port->sched_class = PM_CLASS_QSFP28;
+        break;
+    default:
+        port->sched_class = PM_CLASS_SFPP;
+        break;
+    }
+
+    port->sched_due = 0;
+    port->presence_events = pm_event_covers(port->instance);
+
+    for (task = 0; task < PM_TASK_MAX; task++) {
+        pm_sched_entry_t *entry = &port->cold->sched[task];
+
+        entry->port = port;
+        entry->idx = PM_SCHED_IDLE;
+
+        if (0 != pm_sched_cadence(port, task)) {
+            pm_sched_set_due(entry, now);
+        }
+    }
+}
+
+//
+// pm_sched_remove_port: remove all tasks of a port
+//
+void
+pm_sched_remove_port(pm_port_t *port)
+{
+    int task;
+
+    for (task = 0; task < PM_TASK_MAX; task++) {
+        pm_sched_heap_remove(&port->cold->sched[task]);
+    }
+    port->sched_due = 0;
+}
+
+//
+// pm_sched_trigger: make a port task due immediately
+//
+void
+pm_sched_trigger(pm_port_t *port, enum pm_task task)
+{
+    pm_sched_entry_t *entry = &port->cold->sched[task];
+    long long int now = time_msec();
+
+    if (PM_SCHED_IDLE == entry->idx || entry->due > now) {
+        pm_sched_set_due(entry, now);
+    }
+}
+
+//
+// pm_sched_set_events: set if a port has a presence event source
+//
+// input: port structure, true if insertion and removal are signaled
+//
+// output: none
+//
+// A port that loses its source is polled right away, and at its normal
+// presence cadence after that.
+//
+void
+pm_sched_set_events(pm_port_t *port, bool presence_events)
+{
+    if (port->presence_events == presence_events) {
+        return;
+    }
+
+    port->presence_events = presence_events;
+
+    if (!presence_events) {
+        pm_sched_trigger(port, PM_TASK_PRESENCE);
+    }
+}
+
+//
+// pm_sched_at: schedule a port task at a given time (for one-shot tasks)
+//
+void
+pm_sched_at(pm_port_t *port, enum pm_task task, long long int due)
+{
+    pm_sched_set_due(&port->cold->sched[task], due);
+}
+
+//
+// pm_sched_run: mark all due tasks on their ports and reschedule them
+//
+// input: current time, returns PM_TASK_BIT's of all due tasks
+//
+// output: number of ports with due tasks
+//
+size_t
+pm_sched_run(long long int now, unsigned int *tasks)
+{
+    size_t n_ports = 0;
+
+    *tasks = 0;
+
+    while (sched_heap_n > 0 && sched_heap[0]->due <= now) {
+        pm_sched_entry_t *entry = sched_heap[0];
+        pm_port_t *port = entry->port;
+        enum pm_task task = pm_sched_entry_task(entry);
+        long long int cadence;
+
+        if (0 == port->sched_due) {
+            n_ports++;
+        }
+        port->sched_due |= PM_TASK_BIT(task);
+        *tasks |= PM_TASK_BIT(task);
+
+        cadence = pm_sched_cadence(port, task);
+        if (0 == cadence) {
+            pm_sched_heap_remove(entry);
+        } else {
+            pm_sched_set_due(entry, now + cadence);
+        }
+    }
+
+    return n_ports;
+}
+
+//
+// pm_sched_next_deadline: get the time the next task is due
+//
+// output: time in msecs, LLONG_MAX if nothing is scheduled
+//
+long long int
+pm_sched_next_deadline(void)
+{
+    if (0 == sched_heap_n) {
+        return LLONG_MAX;
+    }
+
+    return sched_heap[0]->due;
+}
+
+static int
+pm_sched_find_name(const char *names[], int n_names, const char *name)
+{
+    int idx;
+
+    for (idx = 0; idx < n_names; idx++) {
+        if (0 == strcasecmp(names[idx], name)) {
+            return idx;
+        }
+    }
+
+    return -1;
+}
+
+//
+// pm_sched_set_cadence: change the cadence of a task for a connector class
+//
+// input: class name, task name, cadence in msecs (0 disables the task)
+//
+// output: 0 on success, -1 on invalid input (error message in ds)
+//
+int
+pm_sched_set_cadence(const char *class_name, const char *task_name,
+                     const char *msecs, struct ds *ds)
+{
+    pm_port_t *port;
+    size_t id;
+    long long int now = time_msec();
+    long long int cadence;
+    char *end;
+    int class;
+    int task;
+
+    class = pm_sched_find_name(pm_class_names, PM_CLASS_MAX, class_name);
+    if (class < 0) {
+        ds_put_format(ds, "Unknown connector class: %s", class_name);
+        return -1;
+    }
+
+    task = pm_sched_find_name(pm_task_names, PM_TASK_PERIODIC_MAX, task_name);
+    if (task < 0) {
+        ds_put_format(ds, "Unknown task: %s", task_name);
+        return -1;
+    }
+
+    cadence = strtoll(msecs, &end, 0);
+    if (end == msecs || '\0' != *end || cadence < 0) {
+        ds_put_format(ds, "Invalid cadence: %s", msecs);
+        return -1;
+    }
+
+    pm_cadence[class][task] = cadence;
+
+    // apply the new cadence now, rather than after the old deadline
+    PM_PORT_FOR_EACH(port, id) {
+        pm_sched_entry_t *entry = &port->cold->sched[task];
+
+        if (port->sched_class != class) {
+            continue;
+        }
+
+        cadence = pm_sched_cadence(port, task);
+        if (0 == cadence) {
+            pm_sched_heap_remove(entry);
+        } else if (PM_SCHED_IDLE == entry->idx ||
+                   entry->due > now + cadence) {
+            pm_sched_set_due(entry, now + cadence);
+        }
+    }
+
+    ds_put_format(ds, "%s %s cadence set to %lld msecs",
+                  pm_class_names[class], pm_task_names[task],
+                  pm_cadence[class][task]);
+
+    return 0;
+}
+
+//
+// pm_sched_dump_cadence: show the task cadences of all connector classes
+//
+void
+pm_sched_dump_cadence(struct ds *ds)
+{
+    int class;
+    int task;
+
+    ds_put_format(ds, "%-12s", "class");
+    for (task = 0; task < PM_TASK_PERIODIC_MAX; task++) {
+        ds_put_format(ds, " %12s", pm_task_names[task]);
+    }
+    ds_put_cstr(ds, "\n");
+
+    for (class = 0; class < PM_CLASS_MAX; class++) {
+        ds_put_format(ds, "%-12s", pm_class_names[class]);
+        for (task = 0; task < PM_TASK_PERIODIC_MAX; task++) {
+            ds_put_format(ds, " %12lld", pm_cadence[class][task]);
+        }
+        ds_put_cstr(ds, "\n");
+    }
+}
@@ -0,0 +1,251 @@
+/*
+ *  (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License. You may obtain
+ *  a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *  License for the specific language governing permissions and limitations
+ *  under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-pmd
+ *
+ * @file
+ * Source file for grouped per-port signal register reads.
+ *
+ * Per-port signals (module present, interrupt, ...) are usually bits in a
+ * few shared CPLD registers. A signal set groups the ports' i2c_bit_op's by
+ * the register they point into, reads each register once, and hands every
+ * port its own bits from the shared value.
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+
+#include <shash.h>
+
+#include "pmd.h"
+
+VLOG_DEFINE_THIS_MODULE(pm_signal);
+
+extern YamlConfigHandle global_yaml_handle;
+
+// retry up to 2 times if a register read fails
+#define PM_SIGNAL_RETRIES   2
+
+// one shared register, read once per cycle
+struct pm_signal_group {
+    char        *subsystem;
+    i2c_bit_op  op;                 /* combined op for all member bits */
+    uint32_t    value;              /* last value read */
+    int         rc;                 /* result of the last read */
+};
+
+// a port's share of a register group
+struct pm_signal_member {
+    struct pm_signal_group  *group;     /* NULL if the port has no signal */
+    uint32_t                bit_mask;
+};
+
+struct pm_signal_set {
+    const char              *name;      /* signal name, for logging */
+    pm_signal_getter_t      getter;     /* finds a port's i2c_bit_op */
+    struct shash            groups;     /* register key -> group */
+    struct pm_signal_member *members;   /* indexed by port id */
+    size_t                  n_members;
+    bool                    valid;      /* groups match the port table */
+};
+
+//
+// pm_signal_set_create: create a set of grouped signal reads
+//
+// input: signal name, method to get the signal's op for a port
+//
+// output: new signal set
+//
+struct pm_signal_set *
+pm_signal_set_create(const char *name, pm_signal_getter_t getter)
+{
+    struct pm_signal_set *set;
+
+    set = xzalloc(sizeof(*set));
+    set->name = name;
+    set->getter = getter;
+    shash_init(&set->groups);
+    set->members = NULL;
+    set->n_members = 0;
+    set->valid = false;
+
+    return set;
+}
+
+static void
+pm_signal_set_clear(struct pm_signal_set *set)
+{
+    struct shash_node *node;
+
+    SHASH_FOR_EACH(node, &set->groups) {
+        struct pm_signal_group *group = node->data;
+
+        free(group->subsystem);
+        free(group->op.device);
+        free(group);
+    }
+    shash_clear(&set->groups);
+    free(set->members);
+    set->members = NULL;
+    set->n_members = 0;
+}
+
+void
+pm_signal_set_destroy(struct pm_signal_set *set)
+{
+    if (NULL == set) {
+        return;
+    }
+
+    pm_signal_set_clear(set);
+    shash_destroy(&set->groups);
+    free(set);
+}
+
+//
+// pm_signal_set_invalidate: ports have been added or removed, regroup
+//                           before the next read
+//
+void
+pm_signal_set_invalidate(struct pm_signal_set *set)
+{
+    set->valid = false;
+}
+
+//
+// pm_signal_set_rebuild: group the signal ops of all ports by register
+//
+static void
+pm_signal_set_rebuild(struct pm_signal_set *set)
+{
+    pm_port_t *port;
+    size_t n_ports = 0;
+    size_t id;
+
+    pm_signal_set_clear(set);
+
+    set->n_members = pm_port_id_limit();
+    set->members = xcalloc(set->n_members, sizeof(*set->members));
+
+    PM_PORT_FOR_EACH(port, id) {
+        struct pm_signal_group *group;
+        struct pm_signal_member *member;
+        const i2c_bit_op *reg_op;
+        char *key;
+
+        reg_op = set->getter(port);
+        if (NULL == reg_op) {
+            continue;
+        }
+
+        // ops can only share a read if the whole register matches
+        key = xasprintf("%s/%s/%x/%u/%d", port->cold->subsystem, reg_op->device,
+                        reg_op->register_address, reg_op->register_size,
+                        reg_op->negative_polarity);
+
+        group = shash_find_data(&set->groups, key);
+        if (NULL == group) {
+            group = xzalloc(sizeof(*group));
+            group->subsystem = xstrdup(port->cold->subsystem);
+            group->op = *reg_op;
+            group->op.device = xstrdup(reg_op->device);
+            group->op.bit_mask = 0;
+            shash_add(&set->groups, key, group);
+        }
+        group->op.bit_mask |= reg_op->bit_mask;
+
+        free(key);
+
+        member = &set->members[id];
+        member->group = group;
+        member->bit_mask = reg_op->bit_mask;
+        n_ports++;
+    }
+
+    VLOG_DBG("%s: %zu ports in %zu register groups", set->name,
+             n_ports, shash_count(&set->groups));
+
+    set->valid = true;
+}
+
+//
+// pm_signal_set_read: read each register in the set once
+//
+// input: signal set
+//
+// output: none (failures are reported per port by pm_signal_get)
+//
+void
+pm_signal_set_read(struct pm_signal_set *set)
+{
+    struct shash_node *node;
+
+    if (false == set->valid) {
+        pm_signal_set_rebuild(set);
+    }
+
+    SHASH_FOR_EACH(node, &set->groups) {
+        struct pm_signal_group *group = node->data;
+        int retry_count = PM_SIGNAL_RETRIES;
+
+retry_read:
+        group->rc = i2c_reg_read(global_yaml_handle, group->subsystem,
+                                 &group->op, &group->value);
+
+        if (group->rc != 0) {
+            if (retry_count != 0) {
+                VLOG_WARN("%s read failed, retrying: %s 0x%x", set->name,
+                          group->op.device, group->op.register_address);
+                retry_count--;
+                goto retry_read;
+            }
+            VLOG_ERR("unable to read %s: %s 0x%x", set->name,
+                     group->op.device, group->op.register_address);
+            group->value = 0;
+        }
+    }
+}
+
+//
+// pm_signal_get: get a port's bits from the last set read
+//
+// input: signal set, port
+//
+// output: 0 on success, -1 if the port has no signal or the read failed
+//
+int
+pm_signal_get(const struct pm_signal_set *set, const pm_port_t *port,
+              uint32_t *value)
+{
+    const struct pm_signal_member *member;
+
+    if (port->id >= set->n_members) {
+        *value = 0;
+        return -1;
+    }
+
+    member = &set->members[port->id];
+    if (NULL == member->group || 0 != member->group->rc) {
+        *value = 0;
+        return -1;
+    }
+
+    *value = member->group->value & member->bit_mask;
+
+    return 0;
+}
@@ -51,6 +51,9 @@ VLOG_DEFINE_THIS_MODULE(ops_pmd);
 COVERAGE_DEFINE(pmd_reconfigure);
 
 static unixctl_cb_func pmd_unixctl_dump;
+static unixctl_cb_func pmd_unixctl_cadence;
+static unixctl_cb_func pmd_unixctl_deadband;
+static unixctl_cb_func pmd_unixctl_scan_threads;
 #ifdef PLATFORM_SIMULATION
 static unixctl_cb_func pmd_unixctl_sim;
 #endif
@@ -64,19 +67,29 @@ static char *program_version = "0.02";
 
 extern struct ovsdb_idl *idl;
 extern void pmd_reconfigure(struct ovsdb_idl *idl);
-extern int pmd_sim_insert(const char *name, const char *file, struct ds *ds);
-extern int pmd_sim_remove(const char *name, struct ds *ds);
+extern int pmd_sim_insert(const char *name, const char *file, bool notify,
+                          struct ds *ds);
+extern int pmd_sim_remove(const char *name, bool notify, struct ds *ds);
+extern int pmd_sim_dom(const char *name, const char *file, struct ds *ds);
 
 static void
 pmd_init(const char *remote)
 {
     pm_config_init();
     pm_ovsdb_if_init(remote);
+    pm_event_init();
     unixctl_command_register("ops-pmd/dump", "", 0, 2,
                              pmd_unixctl_dump, NULL);
+    unixctl_command_register("ops-pmd/cadence", "[class task msecs]", 0, 3,
+                             pmd_unixctl_cadence, NULL);
+    unixctl_command_register("ops-pmd/scan-threads", "[on|off]", 0, 1,
+                             pmd_unixctl_scan_threads, NULL);
+    unixctl_command_register("ops-pmd/deadband",
+                             "[measure absolute relative]", 0, 3,
+                             pmd_unixctl_deadband, NULL);
 
 #ifdef PLATFORM_SIMULATION
-    unixctl_command_register("ops-pmd/sim", "", 2, 3,
+    unixctl_command_register("ops-pmd/sim", "", 2, 4,
                              pmd_unixctl_sim, NULL);
 #endif
 }
@@ -84,6 +97,9 @@ pmd_init(const char *remote)
 static void
 pmd_exit(void)
 {
+    pm_event_destroy();
+    pm_scan_destroy();
+    pm_ovsdb_exit();
     ovsdb_idl_destroy(idl);
 }
 
@@ -108,7 +124,10 @@ pmd_run(void)
     // Process DB changes.
     pmd_reconfigure(idl);
 
-    // Scan pluggable modules for current status.
+    // Schedule the ports that have pending module events.
+    pm_event_run();
+
+    // Scan pluggable modules with due tasks for current status.
     rc = pm_read_state();
     if (0 != rc) {
         VLOG_ERR_ONCE("Failed to read pluggable module state, rc=%d\n", rc);
@@ -127,8 +146,20 @@ pmd_wait(void)
 {
     ovsdb_idl_wait(idl);
 
-    // Wakeup periodically for pluggable module detection.
-    poll_timer_wait_at(PM_INTERVAL, __FUNCTION__);
+    // Wakeup when the pending OVSDB update completes.
+    pm_ovsdb_wait();
+
+    // Without the lock pmd_run doesn't scan, so neither overdue tasks nor
+    // pending module events would be cleared; only wait for the IDL then.
+    if (!ovsdb_idl_has_lock(idl)) {
+        return;
+    }
+
+    // Wakeup on module events.
+    pm_event_wait();
+
+    // Wakeup when the next pluggable module task is due.
+    poll_timer_wait_until(pm_sched_next_deadline());
 }
 
 #ifdef PLATFORM_SIMULATION
@@ -140,19 +171,29 @@ pmd_unixctl_sim(struct unixctl_conn *conn, int argc,
 
     int rc = 0;
     const char *interface = argv[1];
+    bool notify = true;
 
     /* usage:
-        ops-pmd/sim <interface> insert <file>
-        ops-pmd/sim <interface> remove
+        ops-pmd/sim <interface> insert <file> [noevent]
+        ops-pmd/sim <interface> remove [noevent]
+        ops-pmd/sim <interface> dom <file>
+
+       noevent leaves the change to the presence sweep.
     */
+    if (argc > 3 && strcmp("noevent", argv[argc - 1]) == 0) {
+        notify = false;
+        argc--;
+    }
+
     if (4 == argc && strcmp("insert", argv[2]) == 0) {
-        rc = pmd_sim_insert(interface, argv[3], &ds);
+        rc = pmd_sim_insert(interface, argv[3], notify, &ds);
     } else if (3 == argc && strcmp("remove", argv[2]) == 0) {
-        rc = pmd_sim_remove(interface, &ds);
+        rc = pmd_sim_remove(interface, notify, &ds);
+    } else if (4 == argc && notify && strcmp("dom", argv[2]) == 0) {
+        rc = pmd_sim_dom(interface, argv[3], &ds);
     } else {
         rc = -1;
-        ds_put_cstr(&ds, "Invalid usage: ... ops-pmd/sim <interface> [insert <file> | remove]");
-        return;
+        ds_put_cstr(&ds, "Invalid usage: ... ops-pmd/sim <interface> [insert <file> | remove] [noevent] | dom <file>");
     }
 
     if (rc < 0) {
@@ -177,6 +218,92 @@ pmd_unixctl_dump(struct unixctl_conn *conn, int argc OVS_UNUSED,
     ds_destroy(&ds);
 }
 
+static void
+pmd_unixctl_cadence(struct unixctl_conn *conn, int argc,
+                    const char *argv[], void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    int rc = 0;
+
+    /* usage:
+        ops-pmd/cadence
+        ops-pmd/cadence <SFP_PLUS|QSFP_PLUS|QSFP28>
+                        <presence|identity|dom|thresholds> <msecs>
+    */
+    if (1 == argc) {
+        pm_sched_dump_cadence(&ds);
+    } else if (4 == argc) {
+        rc = pm_sched_set_cadence(argv[1], argv[2], argv[3], &ds);
+    } else {
+        rc = -1;
+        ds_put_cstr(&ds, "Invalid usage: ... ops-pmd/cadence [<class> <task> <msecs>]");
+    }
+
+    if (rc < 0) {
+        unixctl_command_reply_error(conn, ds_cstr(&ds));
+    } else {
+        unixctl_command_reply(conn, ds_cstr(&ds));
+    }
+
+    ds_destroy(&ds);
+}
+
+static void
+pmd_unixctl_scan_threads(struct unixctl_conn *conn, int argc,
+                         const char *argv[], void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    int rc = 0;
+
+    /* usage:
+        ops-pmd/scan-threads
+        ops-pmd/scan-threads <on|off>
+    */
+    if (1 == argc) {
+        pm_scan_dump_threads(&ds);
+    } else {
+        rc = pm_scan_set_threads(argv[1], &ds);
+    }
+
+    if (rc < 0) {
+        unixctl_command_reply_error(conn, ds_cstr(&ds));
+    } else {
+        unixctl_command_reply(conn, ds_cstr(&ds));
+    }
+
+    ds_destroy(&ds);
+}
+
+static void
+pmd_unixctl_deadband(struct unixctl_conn *conn, int argc,
+                     const char *argv[], void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    int rc = 0;
+
+    /* usage:
+        ops-pmd/deadband
+        ops-pmd/deadband <temperature|vcc|tx_bias|rx_power|tx_power>
+                         <absolute> <relative percent>
+    */
+    if (1 == argc) {
+        pm_dom_dump_deadbands(&ds);
+    } else if (4 == argc) {
+        rc = pm_dom_set_deadband(argv[1], argv[2], argv[3], &ds);
+    } else {
+        rc = -1;
+        ds_put_cstr(&ds, "Invalid usage: ... ops-pmd/deadband [<measure> <absolute> <relative>]");
+    }
+
+    if (rc < 0) {
+        unixctl_command_reply_error(conn, ds_cstr(&ds));
+    } else {
+        unixctl_command_reply(conn, ds_cstr(&ds));
+    }
+
+    ds_destroy(&ds);
+}
+
 int
 main(int argc, char *argv[])
 {